@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Stereo, deinterleaved audio held in memory by the bench tool.
+   Mono sources are duplicated into both channels.
+ */
+struct AudioBuffer
+{
+    double sampleRate = 48000.0;
+    std::vector<float> left;
+    std::vector<float> right;
+
+    uint32_t frames() const { return static_cast<uint32_t>(left.size()); }
+
+    void resize(uint32_t frames)
+    {
+        left.assign(frames, 0.0f);
+        right.assign(frames, 0.0f);
+    }
+};
+
+static inline bool hasExtension(const std::string& path, const char* ext)
+{
+    const size_t len = std::strlen(ext);
+    return path.size() >= len && path.compare(path.size() - len, len, ext) == 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Raw float: interleaved stereo 32-bit float, native endian
+
+static inline bool readRawFile(const std::string& path, AudioBuffer& buf)
+{
+    FILE* const f = std::fopen(path.c_str(), "rb");
+    if (f == nullptr)
+        return false;
+
+    std::vector<float> interleaved;
+    float frame[2];
+    while (std::fread(frame, sizeof(float), 2, f) == 2)
+    {
+        interleaved.push_back(frame[0]);
+        interleaved.push_back(frame[1]);
+    }
+    std::fclose(f);
+
+    buf.resize(static_cast<uint32_t>(interleaved.size() / 2));
+    for (uint32_t i = 0; i < buf.frames(); ++i)
+    {
+        buf.left[i]  = interleaved[i * 2];
+        buf.right[i] = interleaved[i * 2 + 1];
+    }
+    return true;
+}
+
+static inline bool writeRawFile(const std::string& path, const AudioBuffer& buf)
+{
+    FILE* const f = std::fopen(path.c_str(), "wb");
+    if (f == nullptr)
+        return false;
+
+    for (uint32_t i = 0; i < buf.frames(); ++i)
+    {
+        const float frame[2] = { buf.left[i], buf.right[i] };
+        std::fwrite(frame, sizeof(float), 2, f);
+    }
+    std::fclose(f);
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// WAV: reads 16/24/32-bit PCM and 32-bit float (plain or extensible), writes 32-bit float
+
+static inline uint32_t readLE(const uint8_t* p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; ++i)
+        v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+static inline bool readWavFile(const std::string& path, AudioBuffer& buf)
+{
+    FILE* const f = std::fopen(path.c_str(), "rb");
+    if (f == nullptr)
+        return false;
+
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0)
+        data.insert(data.end(), chunk, chunk + n);
+    std::fclose(f);
+
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0)
+        return false;
+
+    uint32_t format = 0, channels = 0, rate = 0, bits = 0;
+    const uint8_t* samples = nullptr;
+    uint32_t sampleBytes = 0;
+
+    for (size_t pos = 12; pos + 8 <= data.size();)
+    {
+        const uint8_t* const id = data.data() + pos;
+        const uint32_t size = readLE(id + 4, 4);
+        const uint8_t* const body = id + 8;
+
+        if (pos + 8 + size > data.size())
+            break;
+
+        if (std::memcmp(id, "fmt ", 4) == 0 && size >= 16)
+        {
+            format   = readLE(body, 2);
+            channels = readLE(body + 2, 2);
+            rate     = readLE(body + 4, 4);
+            bits     = readLE(body + 14, 2);
+
+            // WAVE_FORMAT_EXTENSIBLE, the sub-format GUID starts with the actual format tag
+            if (format == 0xFFFE && size >= 26)
+                format = readLE(body + 24, 2);
+        }
+        else if (std::memcmp(id, "data", 4) == 0)
+        {
+            samples = body;
+            sampleBytes = size;
+        }
+
+        pos += 8 + size + (size & 1);
+    }
+
+    if (samples == nullptr || channels == 0 || rate == 0)
+        return false;
+    if (! ((format == 1 && (bits == 16 || bits == 24 || bits == 32)) || (format == 3 && bits == 32)))
+        return false;
+
+    const uint32_t bytesPerSample = bits / 8;
+    const uint32_t frames = sampleBytes / (bytesPerSample * channels);
+
+    buf.sampleRate = rate;
+    buf.resize(frames);
+
+    for (uint32_t i = 0; i < frames; ++i)
+    {
+        float frame[2] = {};
+
+        for (uint32_t c = 0; c < channels && c < 2; ++c)
+        {
+            const uint8_t* const p = samples + (i * channels + c) * bytesPerSample;
+
+            if (format == 3)
+            {
+                std::memcpy(&frame[c], p, sizeof(float));
+            }
+            else
+            {
+                // sign-extend by shifting into the top of a 32-bit word
+                const int32_t s = static_cast<int32_t>(readLE(p, bytesPerSample) << (32 - bits));
+                frame[c] = static_cast<float>(s / 2147483648.0);
+            }
+        }
+
+        buf.left[i]  = frame[0];
+        buf.right[i] = channels == 1 ? frame[0] : frame[1];
+    }
+
+    return true;
+}
+
+static inline void writeLE(FILE* f, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        std::fputc((v >> (8 * i)) & 0xFF, f);
+}
+
+static inline bool writeWavFile(const std::string& path, const AudioBuffer& buf)
+{
+    FILE* const f = std::fopen(path.c_str(), "wb");
+    if (f == nullptr)
+        return false;
+
+    const uint32_t channels = 2;
+    const uint32_t rate = static_cast<uint32_t>(buf.sampleRate);
+    const uint32_t dataSize = buf.frames() * channels * sizeof(float);
+
+    std::fwrite("RIFF", 1, 4, f);
+    writeLE(f, 36 + dataSize, 4);
+    std::fwrite("WAVEfmt ", 1, 8, f);
+    writeLE(f, 16, 4);
+    writeLE(f, 3, 2);
+    writeLE(f, channels, 2);
+    writeLE(f, rate, 4);
+    writeLE(f, rate * channels * sizeof(float), 4);
+    writeLE(f, channels * sizeof(float), 2);
+    writeLE(f, 32, 2);
+    std::fwrite("data", 1, 4, f);
+    writeLE(f, dataSize, 4);
+
+    for (uint32_t i = 0; i < buf.frames(); ++i)
+    {
+        const float frame[2] = { buf.left[i], buf.right[i] };
+        std::fwrite(frame, sizeof(float), 2, f);
+    }
+
+    std::fclose(f);
+    return true;
+}
+
+static inline bool readAudioFile(const std::string& path, AudioBuffer& buf)
+{
+    return hasExtension(path, ".wav") ? readWavFile(path, buf) : readRawFile(path, buf);
+}
+
+static inline bool writeAudioFile(const std::string& path, const AudioBuffer& buf)
+{
+    return hasExtension(path, ".wav") ? writeWavFile(path, buf) : writeRawFile(path, buf);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
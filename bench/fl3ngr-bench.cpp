@@ -0,0 +1,1756 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+/**
+   Headless renderer and DSP benchmark for WSTD FL3NGR.
+
+   Streams a WAV or raw float file (or generated noise) through the native engine the plugin ships, or through
+   the hvcc output of WSTD_FL3NGR.pd as a reference, optionally driven by a parameter automation script.
+   Reports per-block CPU time, realtime factor and block latency percentiles for a range of block sizes
+   and sample rates.
+ */
+
+#include "Fl3ngrEngine.hpp"
+#include "Fl3ngrPatch.hpp"
+#include "Fl3ngrState.hpp"
+#include "Heavy_WSTD_FL3NGR.h"
+#include "WavFile.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+
+// --------------------------------------------------------------------------------------------------------------------
+// Heap tracking
+//
+// Counts every allocation the process makes while gTrackHeap is set, which the runner sets around the calls a host's
+// audio thread makes. With glibc malloc itself is replaced, so C allocations (the hvcc context's) count too,
+// elsewhere the C++ operators are. So are they in static builds (FL3NGR_BENCH_STATIC), where libc's malloc is linked
+// in and cannot be replaced.
+
+static bool gTrackHeap = false;
+static size_t gHeapAllocations = 0;
+static size_t gHeapBytes = 0;
+
+static inline void trackHeap(size_t bytes)
+{
+    if (gTrackHeap)
+    {
+        ++gHeapAllocations;
+        gHeapBytes += bytes;
+    }
+}
+
+#if defined(__GLIBC__) && ! defined(FL3NGR_BENCH_STATIC)
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+
+void* malloc(size_t size)
+{
+    trackHeap(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    trackHeap(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    trackHeap(size);
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    trackHeap(size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    trackHeap(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    trackHeap(size);
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr != nullptr ? 0 : ENOMEM;
+}
+}
+#else
+void* operator new(size_t size)
+{
+    trackHeap(size);
+    if (void* const ptr = std::malloc(size != 0 ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    trackHeap(size);
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Parameters
+
+static const uint32_t kParameterCount = kFl3ngrParameterCount;
+static const Fl3ngrParameterInfo* const kParameters = kFl3ngrParameters;
+
+static int findParameter(const std::string& name)
+{
+    for (uint32_t i = 0; i < kParameterCount; ++i)
+        if (name == kParameters[i].receiver)
+            return static_cast<int>(i);
+    return -1;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Engines
+
+// The bench measures the native engine, so its engines start out on the EQ crossover where the plugin's default
+// is Classic, the hvcc patch that -e heavy runs anyway. classic.txt selects it.
+static float benchDefault(uint32_t index)
+{
+    return index == paramCrossover ? static_cast<float>(kCrossoverEq) : kParameters[index].def;
+}
+
+class BenchEngine
+{
+public:
+    virtual ~BenchEngine() {}
+    virtual void setParameter(uint32_t index, float value) = 0;
+
+    // a whole restored state, one parameter at a time unless the engine takes them at once
+    virtual void setParameters(const float* values)
+    {
+        for (uint32_t i = 0; i < kParameterCount; ++i)
+            setParameter(i, values[i]);
+    }
+
+    virtual void process(float** inputs, float** outputs, uint32_t frames) = 0;
+    virtual void setTransport(double, double) {}
+    virtual void activate() {}
+    virtual void setRenderThreads(uint32_t) {}
+    virtual void setShortCircuit(bool) {}
+    virtual uint32_t latency() const { return 0; }
+    virtual size_t arenaBytes() const { return 0; }
+    virtual size_t lineBytes(int) const { return 0; }
+    virtual void collectProfile(Fl3ngrProfileCounters&) {}
+};
+
+#if FL3NGR_BAND_COUNT == 3
+class HeavyBenchEngine : public BenchEngine
+{
+    HeavyContextInterface* const context;
+
+public:
+    explicit HeavyBenchEngine(double sampleRate)
+        : context(hv_WSTD_FL3NGR_new(sampleRate))
+    {
+        // like the plugin wrapper, make sure the context starts from the declared defaults
+        for (uint32_t i = 0; i < kParameterCount; ++i)
+            setParameter(i, kParameters[i].def);
+    }
+
+    ~HeavyBenchEngine() override
+    {
+        hv_delete(context);
+    }
+
+    void setParameter(uint32_t index, float value) override
+    {
+        hv_sendFloatToReceiver(context, hv_stringToHash(kParameters[index].receiver), value);
+    }
+
+    void process(float** inputs, float** outputs, uint32_t frames) override
+    {
+        hv_process(context, inputs, outputs, static_cast<int>(frames));
+    }
+};
+#endif
+
+template <class Engine>
+class NativeBenchEngine : public BenchEngine
+{
+    Engine engine;
+#if FL3NGR_BAND_COUNT == 3
+    Fl3ngrPatch patch;
+#endif
+
+public:
+    explicit NativeBenchEngine(double sampleRate)
+    {
+        engine.setSampleRate(sampleRate);
+
+#if FL3NGR_BAND_COUNT == 3
+        // the Classic crossover, like the plugin
+        patch.setSampleRate(sampleRate);
+        engine.setPatch(&patch);
+#endif
+
+        engine.setParameter(paramCrossover, benchDefault(paramCrossover));
+    }
+
+    void setParameter(uint32_t index, float value) override
+    {
+        engine.setParameter(index, value);
+    }
+
+    void setParameters(const float* values) override
+    {
+        engine.setParameters(values);
+    }
+
+    void process(float** inputs, float** outputs, uint32_t frames) override
+    {
+        engine.process(inputs[0], inputs[1], outputs[0], outputs[1], frames);
+    }
+
+    void setTransport(double beats, double bpm) override
+    {
+        engine.setTransport(true, beats, bpm);
+    }
+
+    void activate() override
+    {
+        engine.reset();
+    }
+
+    void setRenderThreads(uint32_t threads) override
+    {
+        engine.setRenderThreads(threads);
+
+        // as a user would for a bounce
+        engine.setParameter(paramRender, threads > 1 ? kRenderOffline : kRenderRealtime);
+    }
+
+    void setShortCircuit(bool shortCircuit) override
+    {
+        engine.setShortCircuit(shortCircuit);
+    }
+
+    uint32_t latency() const override
+    {
+        return engine.getLatency();
+    }
+
+    size_t arenaBytes() const override
+    {
+        return engine.getArenaBytes();
+    }
+
+    size_t lineBytes(int oversampling) const override
+    {
+        return engine.getLineBytes(oversampling);
+    }
+
+    void collectProfile(Fl3ngrProfileCounters& counters) override
+    {
+        counters.collect(engine.getProfiler());
+    }
+};
+
+static BenchEngine* createEngine(const std::string& name, double sampleRate)
+{
+    if (name == "native")
+        return new NativeBenchEngine<Fl3ngrEngine>(sampleRate);
+    if (name == "scalar")
+        return new NativeBenchEngine<Fl3ngrScalarEngine>(sampleRate);
+#if FL3NGR_BAND_COUNT == 3
+    // the patch has three bands, other band counts have no reference
+    if (name == "heavy")
+        return new HeavyBenchEngine(sampleRate);
+#endif
+    return nullptr;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Automation script
+//
+// One point per line: <time in seconds> <parameter name> <value>
+// Points are applied at the start of the block that contains them, blank lines and '#' comments are ignored.
+
+struct AutomationPoint
+{
+    double time;
+    uint32_t index;
+    float value;
+};
+
+static void sortAutomation(std::vector<AutomationPoint>& points)
+{
+    std::stable_sort(points.begin(), points.end(), [](const AutomationPoint& a, const AutomationPoint& b) {
+        return a.time < b.time;
+    });
+}
+
+static bool readAutomation(const std::string& path, std::vector<AutomationPoint>& points)
+{
+    std::ifstream file(path);
+    if (! file)
+    {
+        std::fprintf(stderr, "cannot open automation script '%s'\n", path.c_str());
+        return false;
+    }
+
+    std::string line;
+    for (int lineno = 1; std::getline(file, line); ++lineno)
+    {
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream in(line);
+        AutomationPoint point;
+        std::string name;
+
+        if (! (in >> point.time))
+            continue;
+
+        if (! (in >> name >> point.value))
+        {
+            std::fprintf(stderr, "%s:%d: expected '<time> <parameter> <value>'\n", path.c_str(), lineno);
+            return false;
+        }
+
+        const int index = findParameter(name);
+        if (index < 0)
+        {
+            std::fprintf(stderr, "%s:%d: unknown parameter '%s'\n", path.c_str(), lineno, name.c_str());
+            return false;
+        }
+
+        point.index = static_cast<uint32_t>(index);
+        point.value = std::max(kParameters[index].min, std::min(kParameters[index].max, point.value));
+        points.push_back(point);
+    }
+
+    sortAutomation(points);
+    return true;
+}
+
+/**
+   Dense modulation of every continuous parameter, as an LFO plugin or a drawn curve would send it.
+   Each parameter gets `rate` points per second along its own slow sine, kept inside the middle 80% of its range
+   so bands never switch off.
+ */
+static void generateModulation(std::vector<AutomationPoint>& points, double rate, double seconds)
+{
+    for (uint32_t index = 0; index < kParameterCount; ++index)
+    {
+        const Fl3ngrParameterInfo& info(kParameters[index]);
+        if (info.hints & kFl3ngrHintChoice)
+            continue;
+
+        const double sweepHz = 0.3 + 0.07 * index;
+        const double center = 0.5 * (info.min + info.max);
+        const double depth = 0.4 * (info.max - info.min);
+
+        for (double t = 0.0; t < seconds; t += 1.0 / rate)
+        {
+            AutomationPoint point;
+            point.time = t;
+            point.index = index;
+            point.value = static_cast<float>(center + depth * std::sin(2.0 * M_PI * sweepHz * t));
+            points.push_back(point);
+        }
+    }
+
+    sortAutomation(points);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Runner
+
+struct RunStats
+{
+    double sampleRate;
+    uint32_t blockSize;
+    double audioSeconds;
+    double cpuSeconds;
+    double avgUs;
+    double p50Us;
+    double p99Us;
+    double maxUs;
+    std::vector<double> blockUs;
+    Fl3ngrProfileCounters profile;
+    size_t heapAllocations;
+    size_t heapBytes;
+    uint32_t latency;
+};
+
+struct RunOptions
+{
+    std::string engine = "native";
+    uint32_t instances = 1;
+    double warmupSeconds = 0.5;
+    double tempo = 0.0;
+    bool denormals = false;
+    uint32_t threads = 1;
+    bool shortCircuit = true;
+};
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    const size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+static bool runPass(const RunOptions& opts,
+                    const AudioBuffer& input,
+                    const std::vector<AutomationPoint>& automation,
+                    double sampleRate,
+                    uint32_t blockSize,
+                    AudioBuffer* output,
+                    RunStats& stats)
+{
+    typedef std::chrono::steady_clock clock;
+
+    std::vector<BenchEngine*> engines;
+    for (uint32_t i = 0; i < opts.instances; ++i)
+    {
+        BenchEngine* const engine = createEngine(opts.engine, sampleRate);
+        if (engine == nullptr)
+        {
+            std::fprintf(stderr, "unknown engine '%s'\n", opts.engine.c_str());
+            for (BenchEngine* e : engines)
+                delete e;
+            return false;
+        }
+        engine->setRenderThreads(opts.threads);
+        engine->setShortCircuit(opts.shortCircuit);
+        engines.push_back(engine);
+    }
+
+    std::vector<float> inL(blockSize), inR(blockSize), outL(blockSize), outR(blockSize);
+    float* inputs[2] = { inL.data(), inR.data() };
+    float* outputs[2] = { outL.data(), outR.data() };
+
+    // the plugin processes with flush-to-zero, -d measures what the engine does without it
+    std::unique_ptr<Fl3ngrScopedFlushToZero> ftz(opts.denormals ? nullptr : new Fl3ngrScopedFlushToZero());
+
+    // settle every instance on silence before measuring
+    const uint32_t warmupBlocks = static_cast<uint32_t>(opts.warmupSeconds * sampleRate / blockSize);
+    for (uint32_t b = 0; b < warmupBlocks; ++b)
+        for (BenchEngine* engine : engines)
+            engine->process(inputs, outputs, blockSize);
+
+    engines.front()->collectProfile(stats.profile);
+    stats.profile.clear();
+
+    if (output != nullptr)
+    {
+        output->sampleRate = sampleRate;
+        output->resize(input.frames());
+    }
+
+    const uint32_t frames = input.frames();
+    std::vector<double> blockUs;
+    blockUs.reserve(frames / blockSize + 1);
+    size_t nextPoint = 0;
+    double cpuSeconds = 0.0;
+
+    gHeapAllocations = 0;
+    gHeapBytes = 0;
+
+    for (uint32_t pos = 0; pos < frames; pos += blockSize)
+    {
+        const uint32_t n = std::min(blockSize, frames - pos);
+
+        std::copy_n(input.left.data() + pos, n, inL.data());
+        std::copy_n(input.right.data() + pos, n, inR.data());
+        std::fill(inL.begin() + n, inL.end(), 0.0f);
+        std::fill(inR.begin() + n, inR.end(), 0.0f);
+
+        const double blockEnd = (pos + n) / sampleRate;
+
+        const clock::time_point start = clock::now();
+
+        // what a host's audio thread calls
+        gTrackHeap = true;
+
+        for (; nextPoint < automation.size() && automation[nextPoint].time < blockEnd; ++nextPoint)
+            for (BenchEngine* engine : engines)
+                engine->setParameter(automation[nextPoint].index, automation[nextPoint].value);
+
+        // a playing host transport that starts with the input
+        if (opts.tempo > 0.0)
+            for (BenchEngine* engine : engines)
+                engine->setTransport(pos / sampleRate * opts.tempo / 60.0, opts.tempo);
+
+        for (BenchEngine* engine : engines)
+            engine->process(inputs, outputs, blockSize);
+
+        gTrackHeap = false;
+
+        const double elapsed = std::chrono::duration<double>(clock::now() - start).count() / opts.instances;
+
+        cpuSeconds += elapsed;
+        blockUs.push_back(elapsed * 1e6);
+
+        // stage timings of the first instance, drained every block so its ring never overflows
+        engines.front()->collectProfile(stats.profile);
+
+        if (output != nullptr)
+        {
+            // the buffers hold the last instance's block, every instance sees the same input and automation
+            std::copy_n(outL.data(), n, output->left.data() + pos);
+            std::copy_n(outR.data(), n, output->right.data() + pos);
+        }
+    }
+
+    // what the first instance reports after the pass, a new oversampling factor takes effect while processing
+    stats.latency = engines.front()->latency();
+
+    for (BenchEngine* engine : engines)
+        delete engine;
+
+    std::vector<double> sorted(blockUs);
+    std::sort(sorted.begin(), sorted.end());
+
+    stats.sampleRate   = sampleRate;
+    stats.blockSize    = blockSize;
+    stats.audioSeconds = frames / sampleRate;
+    stats.cpuSeconds   = cpuSeconds;
+    stats.avgUs        = sorted.empty() ? 0.0 : cpuSeconds * 1e6 / sorted.size();
+    stats.p50Us        = percentile(sorted, 0.50);
+    stats.p99Us        = percentile(sorted, 0.99);
+    stats.maxUs        = sorted.empty() ? 0.0 : sorted.back();
+    stats.blockUs.swap(blockUs);
+    stats.heapAllocations = gHeapAllocations;
+    stats.heapBytes = gHeapBytes;
+    return true;
+}
+
+static void printHeader()
+{
+    std::printf("%7s %6s %11s %7s %10s %10s %10s %10s\n",
+                "rate", "block", "rt-factor", "cpu%", "avg(us)", "p50(us)", "p99(us)", "max(us)");
+}
+
+static void printStats(const RunStats& s)
+{
+    const double rtFactor = s.cpuSeconds > 0.0 ? s.audioSeconds / s.cpuSeconds : 0.0;
+    const double cpu = s.audioSeconds > 0.0 ? 100.0 * s.cpuSeconds / s.audioSeconds : 0.0;
+
+    std::printf("%7.0f %6u %10.1fx %7.3f %10.2f %10.2f %10.2f %10.2f\n",
+                s.sampleRate, s.blockSize, rtFactor, cpu, s.avgUs, s.p50Us, s.p99Us, s.maxUs);
+}
+
+static bool writeProfile(FILE* f, const RunStats& s)
+{
+    if (s.profile.blocks() == 0)
+        return false;
+
+    for (uint32_t i = 0; i < kProfileStageCount; ++i)
+        std::fprintf(f, "%.0f,%u,%s,%.3f,%.3f,%.3f\n", s.sampleRate, s.blockSize, kFl3ngrProfileStageNames[i],
+                     s.profile.get(i, kProfileMin), s.profile.get(i, kProfileAvg), s.profile.get(i, kProfileMax));
+    return true;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Magnitude response, H1 estimate |Sxy| / Sxx over Hann windowed, half overlapping frames of both channels
+
+static void fft(std::vector<std::complex<double>>& x)
+{
+    const size_t n = x.size();
+
+    for (size_t i = 1, j = 0; i < n; ++i)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(x[i], x[j]);
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        const std::complex<double> step = std::polar(1.0, -2.0 * M_PI / len);
+        for (size_t i = 0; i < n; i += len)
+        {
+            std::complex<double> w(1.0);
+            for (size_t k = 0; k < len / 2; ++k, w *= step)
+            {
+                const std::complex<double> u = x[i + k];
+                const std::complex<double> v = x[i + k + len / 2] * w;
+                x[i + k] = u + v;
+                x[i + k + len / 2] = u - v;
+            }
+        }
+    }
+}
+
+static const uint32_t kResponseSize = 4096;
+
+/**
+   Input to output magnitude response in dB, kResponseSize / 2 + 1 bins from DC to Nyquist.
+   Input and output must be the same length, the first frame skips the engine's settling.
+ */
+static std::vector<double> magnitudeResponseDb(const AudioBuffer& input, const AudioBuffer& output)
+{
+    const uint32_t size = kResponseSize;
+    const uint32_t hop = size / 2;
+    const uint32_t bins = size / 2 + 1;
+
+    std::vector<double> window(size);
+    for (uint32_t i = 0; i < size; ++i)
+        window[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / size);
+
+    std::vector<std::complex<double>> sxy(bins);
+    std::vector<double> sxx(bins, 0.0);
+    std::vector<std::complex<double>> x(size), y(size);
+
+    for (int c = 0; c < 2; ++c)
+    {
+        const std::vector<float>& in = c == 0 ? input.left : input.right;
+        const std::vector<float>& out = c == 0 ? output.left : output.right;
+
+        for (uint32_t pos = size; pos + size <= input.frames(); pos += hop)
+        {
+            for (uint32_t i = 0; i < size; ++i)
+            {
+                x[i] = in[pos + i] * window[i];
+                y[i] = out[pos + i] * window[i];
+            }
+            fft(x);
+            fft(y);
+
+            for (uint32_t k = 0; k < bins; ++k)
+            {
+                sxy[k] += std::conj(x[k]) * y[k];
+                sxx[k] += std::norm(x[k]);
+            }
+        }
+    }
+
+    std::vector<double> db(bins, 0.0);
+    for (uint32_t k = 0; k < bins; ++k)
+        if (sxx[k] > 0.0)
+            db[k] = 20.0 * std::log10(std::abs(sxy[k]) / sxx[k]);
+    return db;
+}
+
+/**
+   Largest value of a response in dB between 20 Hz and 20 kHz, by magnitude.
+ */
+static double worstBinDb(const std::vector<double>& response, double sampleRate, double* worstFreq)
+{
+    double worst = 0.0;
+    *worstFreq = 0.0;
+    for (uint32_t k = 1; k < response.size(); ++k)
+    {
+        const double freq = k * sampleRate / kResponseSize;
+        if (freq < 20.0 || freq > std::min(20000.0, 0.45 * sampleRate))
+            continue;
+
+        const double db = response[k];
+        if (std::fabs(db) > std::fabs(worst))
+        {
+            worst = db;
+            *worstFreq = freq;
+        }
+    }
+    return worst;
+}
+
+/**
+   Largest deviation from 0 dB of the magnitude response between 20 Hz and 20 kHz.
+ */
+static double responseDeviationDb(const AudioBuffer& input, const AudioBuffer& output, double* worstFreq)
+{
+    return worstBinDb(magnitudeResponseDb(input, output), input.sampleRate, worstFreq);
+}
+
+/**
+   Lag in frames, up to maxLag, at which the output correlates best with the input, the delay of a flat response.
+ */
+static uint32_t measuredDelay(const AudioBuffer& input, const AudioBuffer& output, uint32_t maxLag)
+{
+    uint32_t best = 0;
+    double bestSum = -HUGE_VAL;
+
+    // past the first frame, like magnitudeResponseDb()
+    const uint32_t start = kResponseSize;
+    const uint32_t end = std::min<uint32_t>(input.frames(), start + 8 * kResponseSize);
+
+    for (uint32_t lag = 0; lag <= maxLag && start + lag < end; ++lag)
+    {
+        double sum = 0.0;
+        for (uint32_t i = start; i + lag < end; ++i)
+            sum += static_cast<double>(input.left[i]) * output.left[i + lag]
+                 + static_cast<double>(input.right[i]) * output.right[i + lag];
+
+        if (sum > bestSum)
+        {
+            bestSum = sum;
+            best = lag;
+        }
+    }
+
+    return best;
+}
+
+/**
+   Largest difference between the magnitude responses of two renders of the same input, between 20 Hz and 20 kHz.
+ */
+static double responseDifferenceDb(const AudioBuffer& input, const AudioBuffer& a, const AudioBuffer& b,
+                                   double* worstFreq)
+{
+    std::vector<double> difference = magnitudeResponseDb(input, a);
+    const std::vector<double> other = magnitudeResponseDb(input, b);
+    for (size_t k = 0; k < difference.size(); ++k)
+        difference[k] -= other[k];
+    return worstBinDb(difference, input.sampleRate, worstFreq);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Interpolation table
+
+/**
+   Every flanger 100% wet at a standing delay half a sample past a whole one, through the flat LR4 crossover.
+   What is left of the response is the interpolator's own, the worst case for linear interpolation.
+ */
+static std::vector<AutomationPoint> halfSampleDelay(uint32_t interpolation, double sampleRate)
+{
+    // intensity scales the 20 ms maximum delay, the LFO sits at the middle of its swing with the speed at 0
+    const float intensity = static_cast<float>(100.0 / (Fl3ngrEngine::kMaxDelayMs * 0.001 * sampleRate));
+    std::vector<AutomationPoint> points = {
+        { 0.0, paramCrossover, kCrossoverLR4 }, { 0.0, paramInterpolation, static_cast<float>(interpolation) },
+    };
+
+    for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+    {
+        points.push_back({ 0.0, fl3ngrBandParameter(b, kBandMix), 100.0f });
+        points.push_back({ 0.0, fl3ngrBandParameter(b, kBandSpeed), 0.0f });
+        points.push_back({ 0.0, fl3ngrBandParameter(b, kBandIntensity), intensity });
+    }
+    return points;
+}
+
+/**
+   CPU of each interpolation with the given automation, next to its response at a half sample delay.
+ */
+static bool interpolationTable(const RunOptions& opts,
+                               const AudioBuffer& input,
+                               const std::vector<AutomationPoint>& automation,
+                               double sampleRate,
+                               uint32_t blockSize)
+{
+    static const double freqs[] = { 5000.0, 10000.0, 15000.0, 20000.0 };
+
+    std::printf("# engine=%s rate=%.0f block=%u, response of a standing half sample delay\n",
+                opts.engine.c_str(), sampleRate, blockSize);
+    std::printf("%-9s %11s %10s %10s %9s %9s %9s %9s\n",
+                "interp", "rt-factor", "avg(us)", "p99(us)", "5k(dB)", "10k(dB)", "15k(dB)", "20k(dB)");
+
+    for (uint32_t i = 0; i < kFl3ngrInterpolationCount; ++i)
+    {
+        std::vector<AutomationPoint> timed(automation);
+        timed.insert(timed.begin(), { 0.0, paramInterpolation, static_cast<float>(i) });
+
+        RunStats stats, still;
+        AudioBuffer output;
+        if (! runPass(opts, input, timed, sampleRate, blockSize, nullptr, stats) ||
+            ! runPass(opts, input, halfSampleDelay(i, sampleRate), sampleRate, blockSize, &output, still))
+            return false;
+
+        const std::vector<double> response = magnitudeResponseDb(input, output);
+        const double rtFactor = stats.cpuSeconds > 0.0 ? stats.audioSeconds / stats.cpuSeconds : 0.0;
+
+        std::printf("%-9s %10.1fx %10.2f %10.2f", kFl3ngrInterpolationNames[i], rtFactor, stats.avgUs, stats.p99Us);
+        for (double freq : freqs)
+        {
+            if (freq > 0.45 * sampleRate)
+                std::printf(" %9s", "-");
+            else
+                std::printf(" %9.2f", response[static_cast<size_t>(freq * kResponseSize / sampleRate + 0.5)]);
+        }
+        std::printf("\n");
+    }
+
+    return true;
+}
+
+/**
+   CPU and memory of every band running 1 to kFl3ngrMaxVoices voices, against stacking that many single voice
+   instances, the way an ensemble had to be faked before bands had voices of their own.
+ */
+static bool ensembleTable(const RunOptions& opts,
+                          const AudioBuffer& input,
+                          const std::vector<AutomationPoint>& automation,
+                          double sampleRate,
+                          uint32_t blockSize)
+{
+    gHeapBytes = 0;
+    gTrackHeap = true;
+    BenchEngine* const engine = createEngine(opts.engine, sampleRate);
+    gTrackHeap = false;
+
+    if (engine == nullptr)
+    {
+        std::fprintf(stderr, "unknown engine '%s'\n", opts.engine.c_str());
+        return false;
+    }
+    delete engine;
+
+    const double instanceKiB = gHeapBytes / 1024.0;
+    double single = 0.0;
+
+    std::printf("# engine=%s rate=%.0f block=%u, cpu%% of one instance with every band at 1 to %u voices\n",
+                opts.engine.c_str(), sampleRate, blockSize, kFl3ngrMaxVoices);
+    std::printf("%6s %9s %10s %11s %9s %10s %12s\n",
+                "voices", "cpu%", "per voice", "stacked%", "saving", "heap(KiB)", "stacked(KiB)");
+
+    for (uint32_t voices = 1; voices <= kFl3ngrMaxVoices; ++voices)
+    {
+        std::vector<AutomationPoint> timed(automation);
+        for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+            timed.insert(timed.begin(), { 0.0, fl3ngrBandParameter(b, kBandVoices), static_cast<float>(voices) });
+
+        RunOptions stackedOpts(opts);
+        stackedOpts.instances = voices;
+
+        RunStats stats, stacked;
+        if (! runPass(opts, input, timed, sampleRate, blockSize, nullptr, stats) ||
+            ! runPass(stackedOpts, input, automation, sampleRate, blockSize, nullptr, stacked))
+            return false;
+
+        // stacked passes time each instance, the stack costs all of them
+        const double cpu = 100.0 * stats.cpuSeconds / stats.audioSeconds;
+        const double stackedCpu = 100.0 * stacked.cpuSeconds * voices / stacked.audioSeconds;
+        if (voices == 1)
+            single = cpu;
+
+        std::printf("%6u %9.3f", voices, cpu);
+        if (voices == 1)
+            std::printf(" %10s", "-");
+        else
+            std::printf(" %10.3f", (cpu - single) / (voices - 1));
+        std::printf(" %11.3f %8.0f%% %10.1f %12.1f\n", stackedCpu, 100.0 * (1.0 - cpu / stackedCpu),
+                    instanceKiB, instanceKiB * voices);
+    }
+
+    return true;
+}
+
+/**
+   Per-second median block time of a burst of input followed by silence, while the tails decay.
+   Fails when any second takes more than twice the first one, once the tail has rung out the engine sleeps
+   and the blocks get much cheaper instead.
+ */
+static bool silenceTail(const RunOptions& opts,
+                        AudioBuffer input,
+                        const std::vector<AutomationPoint>& automation,
+                        double sampleRate,
+                        uint32_t blockSize,
+                        double burstSeconds)
+{
+    const uint32_t burst = std::min(input.frames(), static_cast<uint32_t>(burstSeconds * sampleRate));
+    std::fill(input.left.begin() + burst, input.left.end(), 0.0f);
+    std::fill(input.right.begin() + burst, input.right.end(), 0.0f);
+
+    RunStats stats;
+    if (! runPass(opts, input, automation, sampleRate, blockSize, nullptr, stats))
+        return false;
+
+    std::printf("# engine=%s rate=%.0f block=%u, %.2fs burst then silence, %s%s\n",
+                opts.engine.c_str(), sampleRate, blockSize, burstSeconds,
+                opts.denormals ? "denormals on" : "flush-to-zero",
+                FL3NGR_FLUSH_DENORMALS ? ", explicit flushing" : "");
+    std::printf("%7s %10s %10s\n", "second", "p50(us)", "max(us)");
+
+    const size_t perSecond = std::max<size_t>(1, static_cast<size_t>(sampleRate / blockSize));
+    double first = 0.0, slowest = 0.0;
+
+    for (size_t start = 0, second = 0; start < stats.blockUs.size(); start += perSecond, ++second)
+    {
+        std::vector<double> window(stats.blockUs.begin() + start,
+                                   stats.blockUs.begin() + std::min(start + perSecond, stats.blockUs.size()));
+        std::sort(window.begin(), window.end());
+
+        // a partial last second is too short to judge
+        if (window.size() < perSecond / 2)
+            break;
+
+        const double p50 = percentile(window, 0.5);
+        if (second == 0)
+            first = p50;
+        slowest = std::max(slowest, p50);
+        std::printf("%7zu %10.2f %10.2f\n", second, p50, window.back());
+    }
+
+    const double ratio = first > 0.0 ? slowest / first : 0.0;
+    std::printf("slowest second %.2fx the first: %s\n", ratio, ratio <= 2.0 ? "no spikes" : "SPIKES");
+    return ratio <= 2.0;
+}
+
+/**
+   Project load: `count` instances created one after the other, each restored from the same saved state and run for
+   its first block. Once restoring parameter by parameter, as hosts without the state chunk do, once from the
+   "parameters" chunk, both followed by the activation hosts do before processing. The saved state is the defaults with every automation point applied, the first blocks of
+   both must be identical.
+ */
+static bool loadTest(const RunOptions& opts,
+                     const AudioBuffer& input,
+                     const std::vector<AutomationPoint>& automation,
+                     double sampleRate,
+                     uint32_t blockSize,
+                     uint32_t count)
+{
+    typedef std::chrono::steady_clock clock;
+
+    float saved[kParameterCount];
+    for (uint32_t i = 0; i < kParameterCount; ++i)
+        saved[i] = benchDefault(i);
+    for (const AutomationPoint& point : automation)
+        saved[point.index] = point.value;
+
+    const std::string chunk = fl3ngrWriteParameters(saved);
+
+    std::vector<float> inL(blockSize, 0.0f), inR(blockSize, 0.0f), outL(blockSize), outR(blockSize);
+    std::copy_n(input.left.data(), std::min(blockSize, input.frames()), inL.data());
+    std::copy_n(input.right.data(), std::min(blockSize, input.frames()), inR.data());
+    float* inputs[2] = { inL.data(), inR.data() };
+    float* outputs[2] = { outL.data(), outR.data() };
+
+    const Fl3ngrScopedFlushToZero ftz;
+
+    std::printf("# engine=%s rate=%.0f block=%u, %u instances restored from a %zu byte state\n",
+                opts.engine.c_str(), sampleRate, blockSize, count, chunk.size());
+    std::printf("%-16s %12s %12s %12s %12s\n", "restore", "total(ms)", "create(us)", "restore(us)", "block(us)");
+
+    std::vector<float> firstBlocks[2];
+
+    for (int chunked = 0; chunked < 2; ++chunked)
+    {
+        std::vector<BenchEngine*> engines;
+        engines.reserve(count);
+        double createUs = 0.0, restoreUs = 0.0, blockUs = 0.0;
+
+        for (uint32_t n = 0; n < count; ++n)
+        {
+            const clock::time_point start = clock::now();
+
+            BenchEngine* const engine = createEngine(opts.engine, sampleRate);
+            if (engine == nullptr)
+            {
+                std::fprintf(stderr, "unknown engine '%s'\n", opts.engine.c_str());
+                for (BenchEngine* e : engines)
+                    delete e;
+                return false;
+            }
+            engines.push_back(engine);
+
+            const clock::time_point created = clock::now();
+
+            if (chunked)
+            {
+                float values[kParameterCount];
+                fl3ngrReadParameters(chunk.c_str(), values);
+                engine->setParameters(values);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < kParameterCount; ++i)
+                    engine->setParameter(i, saved[i]);
+            }
+
+            engine->activate();
+
+            const clock::time_point restored = clock::now();
+
+            engine->process(inputs, outputs, blockSize);
+
+            const clock::time_point end = clock::now();
+
+            createUs += std::chrono::duration<double, std::micro>(created - start).count();
+            restoreUs += std::chrono::duration<double, std::micro>(restored - created).count();
+            blockUs += std::chrono::duration<double, std::micro>(end - restored).count();
+
+            if (n == 0)
+            {
+                firstBlocks[chunked] = outL;
+                firstBlocks[chunked].insert(firstBlocks[chunked].end(), outR.begin(), outR.end());
+            }
+        }
+
+        for (BenchEngine* engine : engines)
+            delete engine;
+
+        std::printf("%-16s %12.2f %12.2f %12.2f %12.2f\n", chunked ? "state chunk" : "per parameter",
+                    (createUs + restoreUs + blockUs) / 1000.0, createUs / count, restoreUs / count, blockUs / count);
+    }
+
+    const bool same = firstBlocks[0] == firstBlocks[1];
+    std::printf("first blocks %s\n", same ? "identical" : "DIFFER");
+    return same;
+}
+
+/**
+   What one instance allocates at each rate: the heap it takes to create, and for the native engines the delay line
+   arena in it and how much of that the lines use at each oversampling factor.
+ */
+static bool footprint(const RunOptions& opts, const std::vector<double>& sampleRates)
+{
+    std::printf("# engine=%s, one instance\n", opts.engine.c_str());
+    std::printf("%7s %10s %7s %11s %9s %9s %9s\n", "rate", "heap(KiB)", "allocs", "arena(KiB)", "1x(KiB)", "2x(KiB)", "4x(KiB)");
+
+    for (double sampleRate : sampleRates)
+    {
+        gHeapAllocations = 0;
+        gHeapBytes = 0;
+        gTrackHeap = true;
+        BenchEngine* const engine = createEngine(opts.engine, sampleRate);
+        gTrackHeap = false;
+
+        if (engine == nullptr)
+        {
+            std::fprintf(stderr, "unknown engine '%s'\n", opts.engine.c_str());
+            return false;
+        }
+
+        std::printf("%7.0f %10.1f %7zu %11.1f %9.1f %9.1f %9.1f\n", sampleRate, gHeapBytes / 1024.0, gHeapAllocations,
+                    engine->arenaBytes() / 1024.0, engine->lineBytes(kOversampling1x) / 1024.0,
+                    engine->lineBytes(kOversampling2x) / 1024.0, engine->lineBytes(kOversampling4x) / 1024.0);
+        delete engine;
+    }
+
+    return true;
+}
+
+/**
+   Render with the given automation plus a change of crossover, oversampling, interpolation, sync and voices every
+   quarter second, with a band switching off and on and the host transport playing, so the audio thread takes every path
+   it has. Fails if any of it touches the heap.
+ */
+static bool heapCheck(const RunOptions& opts,
+                      const AudioBuffer& input,
+                      std::vector<AutomationPoint> automation,
+                      double sampleRate,
+                      uint32_t blockSize)
+{
+    const double seconds = input.frames() / sampleRate;
+    const uint32_t gain = fl3ngrBandParameter(0, kBandGain);
+
+    for (uint32_t step = 0; step * 0.25 < seconds; ++step)
+    {
+        const double time = step * 0.25;
+        automation.push_back({ time, paramOversampling, static_cast<float>(step % 3) });
+        automation.push_back({ time, paramInterpolation, static_cast<float>(step / 3 % 4) });
+        automation.push_back({ time, paramCrossover, static_cast<float>(step / 4 % kFl3ngrCrossoverCount) });
+        automation.push_back({ time, paramSync, static_cast<float>(step % 2) });
+        automation.push_back({ time, fl3ngrBandParameter(1, kBandVoices), static_cast<float>(1 + step % 4) });
+        automation.push_back({ time, gain, step % 4 == 2 ? kParameters[gain].min : kParameters[gain].def });
+    }
+    sortAutomation(automation);
+
+    RunOptions playing(opts);
+    if (playing.tempo <= 0.0)
+        playing.tempo = 120.0;
+
+    RunStats stats;
+    if (! runPass(playing, input, automation, sampleRate, blockSize, nullptr, stats))
+        return false;
+
+    std::printf("# engine=%s rate=%.0f block=%u, %zu automation points\n",
+                opts.engine.c_str(), sampleRate, blockSize, automation.size());
+    std::printf("%zu heap allocations (%zu bytes) while processing: %s\n",
+                stats.heapAllocations, stats.heapBytes, stats.heapAllocations == 0 ? "none" : "FAIL");
+    return stats.heapAllocations == 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Math kernels, against libm in double precision
+
+static float firstLane(const Fl3ngrVec4& v)
+{
+    float lanes[4];
+    v.store(lanes);
+    return lanes[0];
+}
+
+/**
+   Total harmonic distortion of a sine that makes `cycles` whole cycles over a power of two number of samples:
+   the power of its harmonics below Nyquist against the fundamental's, in dB.
+ */
+static double sineThdDb(const std::vector<double>& samples, uint32_t cycles)
+{
+    std::vector<std::complex<double>> bins(samples.begin(), samples.end());
+    fft(bins);
+
+    double harmonics = 0.0;
+    for (size_t bin = 2 * cycles; bin < bins.size() / 2; bin += cycles)
+        harmonics += std::norm(bins[bin]);
+
+    return 10.0 * std::log10(std::max(harmonics, 1e-300) / std::norm(bins[cycles]));
+}
+
+/**
+   Average ns a kernel takes per value, over a buffer of inputs processed four at a time.
+ */
+template <class Kernel>
+static double nsPerValue(const std::vector<float>& inputs, Kernel kernel)
+{
+    typedef std::chrono::steady_clock clock;
+    static const uint32_t kRepeats = 2000;
+    volatile float sink = 0.0f;
+
+    const clock::time_point start = clock::now();
+    for (uint32_t r = 0; r < kRepeats; ++r)
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i + 4 <= inputs.size(); i += 4)
+            sum += kernel(&inputs[i]);
+        sink = sink + sum;
+    }
+    const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+
+    return 1e9 * elapsed / (static_cast<double>(kRepeats) * inputs.size());
+}
+
+static bool printKernel(const char* name, double error, double bound, const char* unit, double thd,
+                        double ns, double libmNs)
+{
+    const bool ok = error <= bound;
+    char thdText[16] = "-", libmText[16] = "-";
+    if (thd < 0.0)
+        std::snprintf(thdText, sizeof(thdText), "%.1f", thd);
+    if (libmNs > 0.0)
+        std::snprintf(libmText, sizeof(libmText), "%.2f", libmNs);
+
+    std::printf("%-24s %9.2e %9.0e %-4s %9s %8.2f %8s  %s\n",
+                name, error, bound, unit, thdText, ns, libmText, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+/**
+   Error, harmonic distortion and speed of the LFO and conversion kernels of Fl3ngrFastMath.hpp next to libm.
+   Fails if any kernel strays further from libm than the bound it documents. The quadrature LFO runs as in the engine:
+   started from the phase at every chunk and turned by one sub-block at every edge, at the slowest and fastest speeds.
+ */
+static bool mathReport()
+{
+    typedef Fl3ngrVec4 V;
+    static const uint32_t kCycleSize = 4096;
+    static const double kTwoPi = 2.0 * M_PI;
+
+    std::printf("# math kernels, this build uses %s, ramp=%u chunk=%u\n",
+                FL3NGR_FAST_MATH ? "the fast kernels (FL3NGR_FAST_MATH=1)" : "libm and fl3ngrSin2Pi()",
+                Fl3ngrEngine::kRampSize, Fl3ngrEngine::kChunkSize);
+    std::printf("%-24s %9s %9s %-4s %9s %8s %8s\n", "kernel", "error", "bound", "", "THD(dB)", "ns", "libm ns");
+
+    bool ok = true;
+
+    // the sines over one cycle, their THD next to that of sinf()
+    std::vector<float> phases(kCycleSize);
+    for (uint32_t i = 0; i < kCycleSize; ++i)
+        phases[i] = static_cast<float>(i) / kCycleSize;
+
+    const auto sinf2Pi = [](const float* p) {
+        return std::sin(6.2831853f * p[0]) + std::sin(6.2831853f * p[1])
+             + std::sin(6.2831853f * p[2]) + std::sin(6.2831853f * p[3]);
+    };
+    const double libmSinNs = nsPerValue(phases, sinf2Pi);
+
+    {
+        std::vector<double> cycle(kCycleSize);
+        for (uint32_t i = 0; i < kCycleSize; ++i)
+            cycle[i] = std::sin(6.2831853f * phases[i]);
+        std::printf("%-24s %9s %9s %-4s %9.1f %8.2f\n", "sinf (libm)", "-", "-", "", sineThdDb(cycle, 1), libmSinNs);
+    }
+
+    for (int fast = 0; fast < 2; ++fast)
+    {
+        double error = 0.0;
+        for (uint32_t i = 0; i < 1u << 20; ++i)
+        {
+            const float p = static_cast<float>(i) / (1u << 20);
+            const float y = firstLane(fast ? fl3ngrFastSin2Pi(V::set1(p)) : fl3ngrSin2Pi(V::set1(p)));
+            error = std::max(error, std::fabs(y - std::sin(kTwoPi * p)));
+        }
+
+        std::vector<double> cycle(kCycleSize);
+        for (uint32_t i = 0; i < kCycleSize; ++i)
+            cycle[i] = firstLane(fast ? fl3ngrFastSin2Pi(V::set1(phases[i])) : fl3ngrSin2Pi(V::set1(phases[i])));
+
+        const double ns = fast
+            ? nsPerValue(phases, [](const float* p) { return firstLane(fl3ngrFastSin2Pi(V::load(p))); })
+            : nsPerValue(phases, [](const float* p) { return firstLane(fl3ngrSin2Pi(V::load(p))); });
+
+        ok = printKernel(fast ? "fl3ngrFastSin2Pi" : "fl3ngrSin2Pi", error, fast ? 1e-5 : 6e-7, "abs",
+                         sineThdDb(cycle, 1), ns, libmSinNs) && ok;
+    }
+
+    // the quadrature LFO at 44.1 kHz, chunks start over from the phase the engine keeps in float
+    const uint32_t edges = Fl3ngrEngine::kChunkSize / Fl3ngrEngine::kRampSize;
+    static const double kSpeeds[] = { 0.01, 20.0 };
+
+    for (double speed : kSpeeds)
+    {
+        const float step = static_cast<float>(speed / 44100.0 * Fl3ngrEngine::kRampSize);
+        double error = 0.0;
+        float phase = 0.0f;
+
+        for (uint32_t chunk = 0; chunk < 44100 * 10 / Fl3ngrEngine::kChunkSize; ++chunk)
+        {
+            Fl3ngrQuadrature<V> quadrature;
+            quadrature.start(V::set1(phase), V::set1(step));
+
+            for (uint32_t e = 1; e <= edges; ++e)
+            {
+                quadrature.advance();
+                const double exact = std::sin(kTwoPi * (static_cast<double>(phase) + e * static_cast<double>(step)));
+                error = std::max(error, std::fabs(firstLane(quadrature.sin) - exact));
+            }
+
+            phase = firstLane(wrapUnit(V::set1(phase + edges * step)));
+        }
+
+        // THD over the edges of whole cycles, with a step that fits them into kCycleSize edges
+        const uint32_t cycles = std::max(1u, static_cast<uint32_t>(step * kCycleSize + 0.5f));
+        const float cycleStep = static_cast<float>(cycles) / kCycleSize;
+        std::vector<double> samples(kCycleSize);
+        for (uint32_t i = 0; i < kCycleSize; i += edges)
+        {
+            Fl3ngrQuadrature<V> quadrature;
+            const float start = static_cast<float>(static_cast<double>(i) * cycles / kCycleSize
+                                                   - std::floor(static_cast<double>(i) * cycles / kCycleSize));
+            quadrature.start(V::set1(start), V::set1(cycleStep));
+            for (uint32_t e = 0; e < edges && i + e < kCycleSize; ++e, quadrature.advance())
+                samples[i + e] = firstLane(quadrature.sin);
+        }
+
+        const double ns = nsPerValue(phases, [step](const float* p) {
+            Fl3ngrQuadrature<V> quadrature;
+            quadrature.start(V::load(p), V::set1(step));
+            for (uint32_t e = 1; e < edges; ++e)
+                quadrature.advance();
+            return firstLane(quadrature.sin);
+        }) / edges;
+
+        char name[48];
+        std::snprintf(name, sizeof(name), "Fl3ngrQuadrature %g Hz", speed);
+        ok = printKernel(name, error, 1e-6, "abs", sineThdDb(samples, cycles), ns, libmSinNs) && ok;
+    }
+
+    // exp2 over the range of the gains and crossover points, log2 over that of the meters
+    std::vector<float> exponents(kCycleSize), gains(kCycleSize);
+    for (uint32_t i = 0; i < kCycleSize; ++i)
+    {
+        exponents[i] = -20.0f + 40.0f * i / kCycleSize;
+        gains[i] = std::pow(10.0f, -6.0f + 7.0f * i / kCycleSize);
+    }
+
+    double expError = 0.0, logError = 0.0, dbToGainError = 0.0, gainToDbError = 0.0;
+    for (uint32_t i = 0; i <= 1u << 20; ++i)
+    {
+        const float x = -20.0f + 40.0f * i / (1u << 20);
+        expError = std::max(expError, std::fabs(fl3ngrFastExp2(x) / std::exp2(static_cast<double>(x)) - 1.0));
+
+        const float db = -60.0f + 80.0f * i / (1u << 20);
+        dbToGainError = std::max(dbToGainError,
+                                 std::fabs(20.0 * std::log10(fl3ngrFastExp2(db * 0.16609640474436813f)) - db));
+
+        const float gain = static_cast<float>(std::pow(10.0, -6.0 + 7.0 * i / (1u << 20)));
+        logError = std::max(logError, std::fabs(fl3ngrFastLog2(gain) - std::log2(static_cast<double>(gain))));
+        gainToDbError = std::max(gainToDbError, std::fabs(6.020599913279624f * fl3ngrFastLog2(gain)
+                                                          - 20.0 * std::log10(static_cast<double>(gain))));
+    }
+
+    const double libmExpNs = nsPerValue(exponents, [](const float* x) {
+        return std::exp2(x[0]) + std::exp2(x[1]) + std::exp2(x[2]) + std::exp2(x[3]);
+    });
+    const double libmLogNs = nsPerValue(gains, [](const float* x) {
+        return std::log2(x[0]) + std::log2(x[1]) + std::log2(x[2]) + std::log2(x[3]);
+    });
+    const double libmDbNs = nsPerValue(exponents, [](const float* x) {
+        return std::pow(10.0f, x[0] / 20.0f) + std::pow(10.0f, x[1] / 20.0f)
+             + std::pow(10.0f, x[2] / 20.0f) + std::pow(10.0f, x[3] / 20.0f);
+    });
+    const double libmLog10Ns = nsPerValue(gains, [](const float* x) {
+        return 20.0f * (std::log10(x[0]) + std::log10(x[1]) + std::log10(x[2]) + std::log10(x[3]));
+    });
+    const double expNs = nsPerValue(exponents, [](const float* x) {
+        return fl3ngrFastExp2(x[0]) + fl3ngrFastExp2(x[1]) + fl3ngrFastExp2(x[2]) + fl3ngrFastExp2(x[3]);
+    });
+    const double logNs = nsPerValue(gains, [](const float* x) {
+        return fl3ngrFastLog2(x[0]) + fl3ngrFastLog2(x[1]) + fl3ngrFastLog2(x[2]) + fl3ngrFastLog2(x[3]);
+    });
+
+    ok = printKernel("fl3ngrFastExp2", expError, 4e-6, "rel", 0.0, expNs, libmExpNs) && ok;
+    ok = printKernel("fl3ngrFastLog2", logError, 4e-6, "abs", 0.0, logNs, libmLogNs) && ok;
+    ok = printKernel("dB to gain (fast)", dbToGainError, 4e-5, "dB", 0.0, expNs, libmDbNs) && ok;
+    ok = printKernel("gain to dB (fast)", gainToDbError, 3e-5, "dB", 0.0, logNs, libmLog10Ns) && ok;
+
+    return ok;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+static void generateNoise(AudioBuffer& buf, double sampleRate, double seconds)
+{
+    // fixed seed xorshift, so every run measures the same material
+    uint32_t state = 0x1337f1a9;
+    buf.sampleRate = sampleRate;
+    buf.resize(static_cast<uint32_t>(seconds * sampleRate));
+
+    for (uint32_t i = 0; i < buf.frames(); ++i)
+    {
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        buf.left[i] = 0.25f * (static_cast<int32_t>(state) / 2147483648.0f);
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        buf.right[i] = 0.25f * (static_cast<int32_t>(state) / 2147483648.0f);
+    }
+}
+
+static std::vector<double> parseList(const char* arg)
+{
+    std::vector<double> values;
+    std::istringstream in(arg);
+    std::string item;
+    while (std::getline(in, item, ','))
+        values.push_back(std::atof(item.c_str()));
+    return values;
+}
+
+static void usage(const char* argv0)
+{
+    std::fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -i FILE        input .wav or interleaved stereo .raw float (default: generated white noise)\n"
+        "  -o FILE        render once and write the result as .wav or .raw instead of benchmarking\n"
+        "  -a FILE        parameter automation script, lines of '<seconds> <parameter> <value>'\n"
+        "  -m RATE        also sweep every continuous parameter with RATE automation points per second\n"
+        "  -e ENGINE      'native' for the shipped engine, 'scalar' for its portable fallback\n"
+        "                 or 'heavy' for the hvcc reference (default: native)\n"
+        "  -c ENGINE      render with both engines and fail if the outputs differ by more than the tolerance\n"
+        "  -t TOLERANCE   maximum absolute sample difference for -c (default: 1e-5)\n"
+        "  -f DB          render once and fail if the magnitude response strays more than DB from flat or the\n"
+        "                 output lags by other than the reported latency, use with an automation script that\n"
+        "                 nulls the flangers (see null-eq.txt), with -c\n"
+        "                 fail if the two engines' responses differ by more than DB instead of comparing samples\n"
+        "  -b N[,N...]    block sizes (default: 16,32,64,128,256,512,1024,2048,4096)\n"
+        "  -r SR[,SR...]  sample rates (default: 44100,48000,96000, or the input file rate)\n"
+        "  -n COUNT       instances processed per block, timings are reported per instance (default: 1)\n"
+        "  -j THREADS     render the bands of blocks of 1024 frames or more on up to THREADS threads, with Render\n"
+        "                 on Offline (builds with FL3NGR_PARALLEL=1, 'make bench PARALLEL=true'), -c then\n"
+        "                 compares with the other engine on one thread\n"
+        "  -s SECONDS     length of generated input (default: 10)\n"
+        "  -F             footprint: heap and delay line arena of one instance at every rate\n"
+        "  -A             error, THD and speed of the fast math kernels against libm, fails past their bounds\n"
+        "  -H             fail if processing touches the heap, with every mode switched through on top of the\n"
+        "                 automation, at the first rate and block size\n"
+        "  -L COUNT       project load: COUNT instances restored from a state, parameter by parameter and\n"
+        "                 from the state chunk, at the first rate and block size (-a sets the saved values)\n"
+        "  -M             mono input: the left channel on both inputs, like a mono track on a stereo bus\n"
+        "  -T BPM         play a host transport at BPM from the start of the input, for Sync = Host\n"
+        "  -q             table of every delay interpolation: CPU with the given automation and the response\n"
+        "                 of a half sample delay, at the first rate and block size\n"
+        "  -V             table of 1 to 4 voices in every band against as many stacked instances, CPU and memory\n"
+        "                 with the given automation, at the first rate and block size\n"
+        "  -z SECONDS     silence tail test: a burst of SECONDS of input then silence, fails if the median\n"
+        "                 block time of any second is more than twice that of the first (use -s for the length)\n"
+        "  -d             leave subnormals enabled instead of processing with flush-to-zero like the plugin\n"
+        "  -S             run bands at 0%% or 100%% mix through the kernel of any other mix instead of skipping the\n"
+        "                 path they do not hear, -c then compares with the other engine skipping it\n"
+        "  -w SECONDS     untimed warmup on silence before each pass (default: 0.5)\n"
+        "  -p FILE        per-stage min/avg/max ns per sample of each pass as CSV, '-' for stdout\n"
+        "                 (native engines built with FL3NGR_PROFILE=1, 'make bench PROFILE=true')\n",
+        argv0);
+}
+
+int main(int argc, char* argv[])
+{
+    RunOptions opts;
+    std::string inputPath, outputPath, automationPath;
+    std::vector<double> blockSizes = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    std::vector<double> sampleRates;
+    std::string compareEngine;
+    std::string profilePath;
+    double tolerance = 1e-5;
+    double flatness = -1.0;
+    bool interpolations = false;
+    bool ensemble = false;
+    double burstSeconds = -1.0;
+    double modulationRate = 0.0;
+    double seconds = 10.0;
+    bool mono = false;
+    uint32_t loadCount = 0;
+    bool footprintReport = false;
+    bool heapTest = false;
+    bool mathTest = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const char* const value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (arg == "-h" || arg == "--help")
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        if (arg == "-q")
+        {
+            interpolations = true;
+            continue;
+        }
+        if (arg == "-V")
+        {
+            ensemble = true;
+            continue;
+        }
+        if (arg == "-d")
+        {
+            opts.denormals = true;
+            continue;
+        }
+        if (arg == "-S")
+        {
+            opts.shortCircuit = false;
+            continue;
+        }
+        if (arg == "-M")
+        {
+            mono = true;
+            continue;
+        }
+        if (arg == "-F")
+        {
+            footprintReport = true;
+            continue;
+        }
+        if (arg == "-H")
+        {
+            heapTest = true;
+            continue;
+        }
+        if (arg == "-A")
+        {
+            mathTest = true;
+            continue;
+        }
+        if (value == nullptr)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        ++i;
+
+        if (arg == "-i")
+            inputPath = value;
+        else if (arg == "-o")
+            outputPath = value;
+        else if (arg == "-a")
+            automationPath = value;
+        else if (arg == "-m")
+            modulationRate = std::atof(value);
+        else if (arg == "-e")
+            opts.engine = value;
+        else if (arg == "-c")
+            compareEngine = value;
+        else if (arg == "-t")
+            tolerance = std::atof(value);
+        else if (arg == "-f")
+            flatness = std::atof(value);
+        else if (arg == "-b")
+            blockSizes = parseList(value);
+        else if (arg == "-r")
+            sampleRates = parseList(value);
+        else if (arg == "-n")
+            opts.instances = std::max(1, std::atoi(value));
+        else if (arg == "-j")
+            opts.threads = static_cast<uint32_t>(std::max(1, std::atoi(value)));
+        else if (arg == "-s")
+            seconds = std::atof(value);
+        else if (arg == "-w")
+            opts.warmupSeconds = std::atof(value);
+        else if (arg == "-p")
+            profilePath = value;
+        else if (arg == "-T")
+            opts.tempo = std::atof(value);
+        else if (arg == "-z")
+            burstSeconds = std::atof(value);
+        else if (arg == "-L")
+            loadCount = static_cast<uint32_t>(std::max(1, std::atoi(value)));
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (mathTest)
+        return mathReport() ? 0 : 1;
+
+    if (opts.threads > 1 && ! FL3NGR_PARALLEL)
+    {
+        std::fprintf(stderr, "-j needs a parallel build, rebuild with 'make bench PARALLEL=true'\n");
+        return 1;
+    }
+
+    std::vector<AutomationPoint> automation;
+    if (! automationPath.empty() && ! readAutomation(automationPath, automation))
+        return 1;
+
+    AudioBuffer input;
+    if (! inputPath.empty())
+    {
+        if (! readAudioFile(inputPath, input))
+        {
+            std::fprintf(stderr, "cannot read input '%s'\n", inputPath.c_str());
+            return 1;
+        }
+        if (sampleRates.empty())
+            sampleRates.push_back(input.sampleRate);
+    }
+    else
+    {
+        if (sampleRates.empty())
+            sampleRates = { 44100, 48000, 96000 };
+        generateNoise(input, sampleRates.front(), seconds);
+    }
+
+    if (mono)
+        input.right = input.left;
+
+    if (blockSizes.empty() || blockSizes.front() < 1.0)
+    {
+        std::fprintf(stderr, "invalid block size list\n");
+        return 1;
+    }
+
+    if (modulationRate > 0.0)
+        generateModulation(automation, modulationRate, input.frames() / input.sampleRate);
+
+    // compare mode: render with both engines and check they agree
+    if (! compareEngine.empty())
+    {
+        const double sampleRate = sampleRates.front();
+        const uint32_t blockSize = static_cast<uint32_t>(blockSizes.front());
+        RunOptions otherOpts(opts);
+        otherOpts.engine = compareEngine;
+        otherOpts.threads = 1;
+        otherOpts.shortCircuit = true;
+
+        AudioBuffer a, b;
+        RunStats stats;
+        if (! runPass(opts, input, automation, sampleRate, blockSize, &a, stats) ||
+            ! runPass(otherOpts, input, automation, sampleRate, blockSize, &b, stats))
+            return 1;
+
+        // engines with different filters never match sample for sample, their responses can
+        if (flatness >= 0.0)
+        {
+            double freq;
+            const double difference = responseDifferenceDb(input, a, b, &freq);
+            std::printf("%s vs %s at %.0f Hz, block %u: magnitude responses within %.3f dB, worst at %.0f Hz\n",
+                        opts.engine.c_str(), compareEngine.c_str(), sampleRate, blockSize, std::fabs(difference),
+                        freq);
+            return std::fabs(difference) <= flatness ? 0 : 1;
+        }
+
+        double maxDiff = 0.0;
+        uint32_t firstDiff = a.frames();
+        for (uint32_t i = 0; i < a.frames(); ++i)
+        {
+            const double diff = std::max(std::fabs(a.left[i] - b.left[i]), std::fabs(a.right[i] - b.right[i]));
+            if (diff > 0.0 && firstDiff == a.frames())
+                firstDiff = i;
+            maxDiff = std::max(maxDiff, diff);
+        }
+
+        const bool exact = firstDiff == a.frames();
+        std::printf("%s vs %s at %.0f Hz, block %u: %s, max abs diff %g (%.1f dBFS)\n",
+                    opts.engine.c_str(), compareEngine.c_str(), sampleRate, blockSize,
+                    exact ? "bit-exact" : "differs", maxDiff, exact ? -HUGE_VAL : 20.0 * std::log10(maxDiff));
+        return maxDiff <= tolerance ? 0 : 1;
+    }
+
+    // flatness mode: render once and measure how far the band sum is from the input
+    if (flatness >= 0.0)
+    {
+        const double sampleRate = sampleRates.front();
+        const uint32_t blockSize = static_cast<uint32_t>(blockSizes.front());
+
+        AudioBuffer output;
+        RunStats stats;
+        if (! runPass(opts, input, automation, sampleRate, blockSize, &output, stats))
+            return 1;
+
+        double freq;
+        const double deviation = responseDeviationDb(input, output, &freq);
+        std::printf("%s at %.0f Hz: magnitude response within %.3f dB of flat, worst at %.0f Hz\n",
+                    opts.engine.c_str(), sampleRate, std::fabs(deviation), freq);
+
+        // what the plugin reports to the host for delay compensation must be what the output lags by
+        const uint32_t delay = measuredDelay(input, output, 1024);
+        std::printf("%s at %.0f Hz: output delayed by %u frames, %u reported\n",
+                    opts.engine.c_str(), sampleRate, delay, stats.latency);
+
+        return std::fabs(deviation) <= flatness && delay == stats.latency ? 0 : 1;
+    }
+
+    if (footprintReport)
+        return footprint(opts, sampleRates) ? 0 : 1;
+
+    if (heapTest)
+    {
+        return heapCheck(opts, input, automation, sampleRates.front(),
+                         static_cast<uint32_t>(blockSizes.front())) ? 0 : 1;
+    }
+
+    if (loadCount > 0)
+    {
+        return loadTest(opts, input, automation, sampleRates.front(),
+                        static_cast<uint32_t>(blockSizes.front()), loadCount) ? 0 : 1;
+    }
+
+    if (burstSeconds >= 0.0)
+    {
+        return silenceTail(opts, input, automation, sampleRates.front(),
+                           static_cast<uint32_t>(blockSizes.front()), burstSeconds) ? 0 : 1;
+    }
+
+    if (interpolations)
+    {
+        if (opts.engine == "heavy")
+        {
+            std::fprintf(stderr, "-q needs a native engine\n");
+            return 1;
+        }
+        return interpolationTable(opts, input, automation, sampleRates.front(),
+                                  static_cast<uint32_t>(blockSizes.front())) ? 0 : 1;
+    }
+
+    if (ensemble)
+    {
+        if (opts.engine == "heavy")
+        {
+            std::fprintf(stderr, "-V needs a native engine\n");
+            return 1;
+        }
+        return ensembleTable(opts, input, automation, sampleRates.front(),
+                             static_cast<uint32_t>(blockSizes.front())) ? 0 : 1;
+    }
+
+    // render mode: one pass at the first rate and block size
+    if (! outputPath.empty())
+    {
+        AudioBuffer output;
+        RunStats stats;
+        if (! runPass(opts, input, automation, sampleRates.front(), static_cast<uint32_t>(blockSizes.front()), &output, stats))
+            return 1;
+        if (! writeAudioFile(outputPath, output))
+        {
+            std::fprintf(stderr, "cannot write output '%s'\n", outputPath.c_str());
+            return 1;
+        }
+        printHeader();
+        printStats(stats);
+        return 0;
+    }
+
+    if (! profilePath.empty() && ! Fl3ngrProfiler::kEnabled)
+    {
+        std::fprintf(stderr, "-p needs a profiling build, rebuild with 'make bench PROFILE=true'\n");
+        return 1;
+    }
+
+    std::printf("# engine=%s vectors=%s ramp=%u instances=%u threads=%u input=%s (%.2fs) automation=%zu points\n",
+                opts.engine.c_str(), Fl3ngrVec4::name(), Fl3ngrEngine::kRampSize, opts.instances, opts.threads,
+                inputPath.empty() ? "noise" : inputPath.c_str(),
+                input.frames() / input.sampleRate, automation.size());
+    printHeader();
+
+    std::vector<RunStats> passes;
+
+    for (double sampleRate : sampleRates)
+    {
+        // generated input keeps its length in seconds at every rate
+        if (inputPath.empty() && sampleRate != input.sampleRate)
+        {
+            generateNoise(input, sampleRate, seconds);
+            if (mono)
+                input.right = input.left;
+        }
+
+        for (double blockSize : blockSizes)
+        {
+            RunStats stats;
+            if (! runPass(opts, input, automation, sampleRate, static_cast<uint32_t>(blockSize), nullptr, stats))
+                return 1;
+            printStats(stats);
+            passes.push_back(stats);
+        }
+    }
+
+    if (! profilePath.empty())
+    {
+        FILE* const f = profilePath == "-" ? stdout : std::fopen(profilePath.c_str(), "w");
+        if (f == nullptr)
+        {
+            std::fprintf(stderr, "cannot write profile '%s'\n", profilePath.c_str());
+            return 1;
+        }
+
+        bool ok = true;
+        std::fprintf(f, "rate,block,stage,min_ns,avg_ns,max_ns\n");
+        for (const RunStats& stats : passes)
+            ok = writeProfile(f, stats) && ok;
+
+        if (f != stdout)
+            std::fclose(f);
+
+        if (! ok)
+        {
+            std::fprintf(stderr, "engine '%s' recorded no stage timings\n", opts.engine.c_str());
+            return 1;
+        }
+    }
+
+    return 0;
+}
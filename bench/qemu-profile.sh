@@ -0,0 +1,75 @@
+#!/bin/sh
+# CPU cost of one FL3NGR instance on the embedded targets, counted under qemu-user.
+#
+# usage: ./qemu-profile.sh [-B MIPS] [bench options]     (after `make embedded`)
+#
+# Emulated time says nothing about a board, so each target's bench runs under qemu with the instruction counting
+# plugin from QEMU's tests (libinsn.so, built with --enable-plugins), which gives the same count on every machine.
+# Two instance counts at two lengths cancel out what is not the engine: startup, generating the input and the
+# bench's own copies. What is left is the instructions one instance executes per second of audio, in millions (MIPS).
+# With -B, the MIPS a board's audio core can spend, it also prints how many instances fit.
+# Bench options come after the defaults (48 kHz, 128 frame blocks), `-a oversampling-2x.txt` prices a setting.
+
+set -e
+cd "$(dirname "$0")"
+
+budget=
+if [ "$1" = "-B" ]; then
+    budget=$2
+    shift 2
+fi
+
+plugin=${QEMU_PLUGIN:-}
+if [ -z "$plugin" ]; then
+    for p in /usr/lib/qemu/plugins/libinsn.so /usr/local/lib/qemu/plugins/libinsn.so \
+             /usr/lib/x86_64-linux-gnu/qemu/plugins/libinsn.so; do
+        [ -f "$p" ] && plugin=$p && break
+    done
+fi
+if [ -z "$plugin" ]; then
+    echo "qemu's libinsn.so not found, point QEMU_PLUGIN at it (build/tests/tcg/plugins/ of a qemu build)" >&2
+    exit 1
+fi
+
+log=$(mktemp)
+trap 'rm -f "$log"' EXIT
+
+# instructions of a bench run with $1 instances of $2 seconds, then the bench options
+count()
+{
+    instances=$1
+    seconds=$2
+    shift 2
+    "$qemu" -cpu "$cpu" -plugin "$plugin" -d plugin -D "$log" ./fl3ngr-bench-"$target" \
+        -r 48000 -b 128 -w 0 "$@" -n "$instances" -s "$seconds" > /dev/null
+    awk '/insns:/ { n = $NF } END { print n }' "$log"
+}
+
+printf '%-8s %-11s %-14s %10s %10s\n' target cpu vectors MIPS instances
+
+for entry in armhf:qemu-arm:cortex-a7 arm64:qemu-aarch64:cortex-a53 riscv64:qemu-riscv64:rv64; do
+    target=${entry%%:*}
+    qemu=${entry#*:}
+    cpu=${qemu#*:}
+    qemu=${qemu%%:*}
+
+    if [ ! -x ./fl3ngr-bench-"$target" ]; then
+        echo "fl3ngr-bench-$target not built, skipped" >&2
+        continue
+    fi
+
+    vectors=$("$qemu" -cpu "$cpu" ./fl3ngr-bench-"$target" -r 48000 -b 128 -w 0 -s 0.01 "$@" |
+              sed -n 's/.*vectors=\([^ ]*\).*/\1/p')
+
+    a=$(count 1 1 "$@")
+    b=$(count 1 3 "$@")
+    c=$(count 3 1 "$@")
+    d=$(count 3 3 "$@")
+
+    # two more instances over two more seconds
+    mips=$(awk -v a="$a" -v b="$b" -v c="$c" -v d="$d" 'BEGIN { printf "%.1f", (d - c - b + a) / 4 / 1e6 }')
+    fit=-
+    [ -n "$budget" ] && fit=$(awk -v m="$mips" -v b="$budget" 'BEGIN { printf "%d", b / m }')
+
+    printf '%-8s %-11s %-14s %10s %10s\n' "$target" "$cpu" "$vectors" "$mips" "$fit"
+done
@@ -0,0 +1,56 @@
+#!/usr/bin/env node
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+/**
+   Runs the WebAssembly builds of the bench under Node, the SIMD128 one and the plain wasm32 one, with the same
+   options and prints their realtime factors side by side. Build them first with `make -C bench wasm`.
+
+     node bench/wasm-compare.js -r 44100,48000 -b 32,64,128,256,512 -s 10
+ */
+
+'use strict';
+
+const { execFileSync } = require('child_process');
+const path = require('path');
+
+const builds = ['simd128', 'wasm32'];
+const args = process.argv.slice(2);
+
+// rows of the bench's table, keyed by "rate block", with the realtime factor and the p99 block time
+function run(build)
+{
+    const script = path.join(__dirname, `fl3ngr-bench-${build}.js`);
+    const output = execFileSync(process.execPath, [script, ...args], { encoding: 'utf8' });
+    const rows = new Map();
+
+    for (const line of output.split('\n'))
+    {
+        const fields = line.trim().split(/\s+/);
+        if (fields.length < 8 || ! /^\d/.test(fields[0]) || ! fields[2].endsWith('x'))
+            continue;
+        rows.set(`${fields[0]} ${fields[1]}`, { rt: parseFloat(fields[2]), p99: parseFloat(fields[6]) });
+    }
+
+    return rows;
+}
+
+const results = builds.map(run);
+
+console.log(`# node ${process.version}, ${args.join(' ') || 'default options'}`);
+console.log(['rate', 'block', 'rt simd128', 'rt wasm32', 'speedup', 'p99 simd128', 'p99 wasm32']
+    .map((title, i) => title.padStart(i < 2 ? 7 : 12)).join(''));
+
+for (const [key, simd] of results[0])
+{
+    const plain = results[1].get(key);
+    if (plain === undefined)
+        continue;
+
+    const [rate, block] = key.split(' ');
+    console.log(rate.padStart(7) + block.padStart(7)
+        + `${simd.rt.toFixed(1)}x`.padStart(12) + `${plain.rt.toFixed(1)}x`.padStart(12)
+        + `${(simd.rt / plain.rt).toFixed(2)}x`.padStart(12)
+        + `${simd.p99.toFixed(2)}us`.padStart(12) + `${plain.p99.toFixed(2)}us`.padStart(12));
+}
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "Fl3ngrFastMath.hpp"
+
+// --------------------------------------------------------------------------------------------------------------------
+// Band layout, fixed at compile time with -DFL3NGR_BAND_COUNT=N (`make BANDS=N`), 2 to 6 bands.
+//
+// Every band is the same unit: a gain, a flanger with feedback, intensity, mix, speed and phase, and the crossover
+// filters that cut it out of the input. Bands are listed from the highest to the lowest, which is the engine's
+// order. The N - 1 crossover points sit kFl3ngrSplitSpan apart, centred on the crossover frequency parameter.
+//
+// FL3NGR_BANDS(X) expands X(receiver, name, symbol) once per band, so the parameter table, the engine, the meters,
+// the profiler and the editor are all generated from the one list below. The default of 3 bands is WSTD FL3NGR
+// itself: WSTD_FL3NGR.pd, its parameter order and its bands meeting an octave either side of Mid Freq.
+
+#ifndef FL3NGR_BAND_COUNT
+# define FL3NGR_BAND_COUNT 3
+#endif
+
+#if FL3NGR_BAND_COUNT == 2
+# define FL3NGR_BANDS(X) \
+    X(High, "High", high) \
+    X(Low,  "Low",  low)
+#elif FL3NGR_BAND_COUNT == 3
+# define FL3NGR_BANDS(X) \
+    X(High, "High", high) \
+    X(Mid,  "Mid",  mid) \
+    X(Low,  "Low",  low)
+#elif FL3NGR_BAND_COUNT == 4
+# define FL3NGR_BANDS(X) \
+    X(High,     "High",     high) \
+    X(High_Mid, "High Mid", high_mid) \
+    X(Low_Mid,  "Low Mid",  low_mid) \
+    X(Low,      "Low",      low)
+#elif FL3NGR_BAND_COUNT == 5
+# define FL3NGR_BANDS(X) \
+    X(High,     "High",     high) \
+    X(High_Mid, "High Mid", high_mid) \
+    X(Mid,      "Mid",      mid) \
+    X(Low_Mid,  "Low Mid",  low_mid) \
+    X(Low,      "Low",      low)
+#elif FL3NGR_BAND_COUNT == 6
+# define FL3NGR_BANDS(X) \
+    X(Air,      "Air",      air) \
+    X(High,     "High",     high) \
+    X(High_Mid, "High Mid", high_mid) \
+    X(Low_Mid,  "Low Mid",  low_mid) \
+    X(Low,      "Low",      low) \
+    X(Sub,      "Sub",      sub)
+#else
+# error "FL3NGR_BAND_COUNT must be between 2 and 6"
+#endif
+
+#define FL3NGR_STRINGIFY_(x) #x
+#define FL3NGR_STRINGIFY(x) FL3NGR_STRINGIFY_(x)
+
+// the plugin carries its band count in its name
+#define FL3NGR_PLUGIN_NAME "WSTD FL" FL3NGR_STRINGIFY(FL3NGR_BAND_COUNT) "NGR"
+
+static const uint32_t kFl3ngrBandCount = FL3NGR_BAND_COUNT;
+static const uint32_t kFl3ngrSplitCount = kFl3ngrBandCount - 1;
+
+// ratio between neighbouring crossover points, narrower when there are more of them so the outer ones stay in band
+static constexpr double kFl3ngrSplitSpan = kFl3ngrBandCount <= 4 ? 4.0 : 3.0;
+
+// the controls every band has
+enum Fl3ngrBandControls
+{
+    kBandGain,
+    kBandFeedback,
+    kBandIntensity,
+    kBandMix,
+    kBandSpeed,
+    kBandPhase,
+    kBandVoices,
+    kFl3ngrBandControlCount
+};
+
+struct Fl3ngrBandInfo
+{
+    const char* name;
+    const char* symbol;
+};
+
+#define FL3NGR_BAND_INFO(receiver, name, symbol) { name, #symbol },
+static const Fl3ngrBandInfo kFl3ngrBands[kFl3ngrBandCount] = { FL3NGR_BANDS(FL3NGR_BAND_INFO) };
+#undef FL3NGR_BAND_INFO
+
+/**
+   Frequency of crossover point `split` for a crossover frequency of `freq`. Split 0 is the highest, it is the lower
+   edge of band 0 and the upper edge of band 1.
+ */
+static inline double fl3ngrSplitFrequency(uint32_t split, double freq)
+{
+#if FL3NGR_FAST_MATH
+    const float octaves = static_cast<float>(std::log2(kFl3ngrSplitSpan) * (0.5 * (kFl3ngrSplitCount - 1) - split));
+    return freq * fl3ngrFastExp2(octaves);
+#else
+    return freq * std::pow(kFl3ngrSplitSpan, 0.5 * (kFl3ngrSplitCount - 1) - split);
+#endif
+}
+
+/**
+   Geometric middle of a band between two crossover points, the crossover frequency itself for the 3 band mid.
+   The outer bands have only one edge, they report it.
+ */
+static inline double fl3ngrBandCenter(uint32_t band, double freq)
+{
+    if (band == 0)
+        return fl3ngrSplitFrequency(0, freq);
+    if (band == kFl3ngrBandCount - 1)
+        return fl3ngrSplitFrequency(kFl3ngrSplitCount - 1, freq);
+    return std::sqrt(fl3ngrSplitFrequency(band - 1, freq) * fl3ngrSplitFrequency(band, freq));
+}
+
+// --------------------------------------------------------------------------------------------------------------------
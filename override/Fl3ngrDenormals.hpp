@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "Fl3ngrSimd.hpp"
+
+#if FL3NGR_SIMD_SSE2 || defined(__SSE__)
+# include <xmmintrin.h>
+# define FL3NGR_HAVE_FTZ 1
+#elif defined(__aarch64__) && defined(__GNUC__)
+# define FL3NGR_HAVE_FTZ 1
+#elif defined(__arm__) && defined(__GNUC__) && defined(__ARM_FP) && ! defined(__SOFTFP__)
+# define FL3NGR_HAVE_FTZ 1
+#else
+# define FL3NGR_HAVE_FTZ 0
+#endif
+
+// flush the feedback and filter state explicitly, by default only where the FPU cannot do it
+#ifndef FL3NGR_FLUSH_DENORMALS
+# define FL3NGR_FLUSH_DENORMALS (! FL3NGR_HAVE_FTZ)
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Subnormals.
+//
+// The flanger feedback loops and the crossover filters decay towards zero once the input stops. Through the
+// subnormal range every operation on them can cost a hundred times more, which shows as a CPU spike exactly
+// when a track goes silent. Where the FPU can flush them (SSE, VFP and AArch64) the process callback runs with
+// flush-to-zero and denormals-are-zero. Builds without that, or built with FL3NGR_FLUSH_DENORMALS=1, set the
+// feedback writes and the filter states to zero once they fall below kFl3ngrFlushThreshold, about -300 dB.
+
+static const float kFl3ngrFlushThreshold = 1e-15f;
+
+/**
+   The calling thread's floating point control register, and setting it. Zero and a no-op where the FPU has no
+   flush-to-zero.
+ */
+static inline uint64_t fl3ngrFloatMode()
+{
+#if FL3NGR_SIMD_SSE2 || defined(__SSE__)
+    return _mm_getcsr();
+#elif defined(__aarch64__) && defined(__GNUC__)
+    uint64_t fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    return fpcr;
+#elif FL3NGR_HAVE_FTZ
+    uint32_t fpscr;
+    __asm__ __volatile__("vmrs %0, fpscr" : "=r"(fpscr));
+    return fpscr;
+#else
+    return 0;
+#endif
+}
+
+static inline void fl3ngrSetFloatMode(uint64_t mode)
+{
+#if FL3NGR_SIMD_SSE2 || defined(__SSE__)
+    _mm_setcsr(static_cast<unsigned int>(mode));
+#elif defined(__aarch64__) && defined(__GNUC__)
+    __asm__ __volatile__("msr fpcr, %0" :: "r"(mode));
+#elif FL3NGR_HAVE_FTZ
+    __asm__ __volatile__("vmsr fpscr, %0" :: "r"(static_cast<uint32_t>(mode)));
+#else
+    (void)mode;
+#endif
+}
+
+/**
+   Flush-to-zero and denormals-are-zero for the lifetime of the object, the previous mode comes back after.
+   Does nothing where the FPU has no such mode.
+ */
+class Fl3ngrScopedFlushToZero
+{
+public:
+    Fl3ngrScopedFlushToZero()
+        : fSaved(fl3ngrFloatMode())
+    {
+#if FL3NGR_SIMD_SSE2 || defined(__SSE__)
+        fl3ngrSetFloatMode(fSaved | 0x8040);  // FTZ | DAZ
+#elif FL3NGR_HAVE_FTZ
+        fl3ngrSetFloatMode(fSaved | (1u << 24));  // FZ
+#endif
+    }
+
+    ~Fl3ngrScopedFlushToZero()
+    {
+        fl3ngrSetFloatMode(fSaved);
+    }
+
+private:
+    const uint64_t fSaved;
+
+    Fl3ngrScopedFlushToZero(const Fl3ngrScopedFlushToZero&) = delete;
+    Fl3ngrScopedFlushToZero& operator=(const Fl3ngrScopedFlushToZero&) = delete;
+};
+
+/**
+   Zero the lanes of a value that has decayed below kFl3ngrFlushThreshold, in builds that flush explicitly.
+ */
+template <class V>
+static inline V fl3ngrFlushDenormals(const V& x)
+{
+#if FL3NGR_FLUSH_DENORMALS
+    return flushBelow(x, V::set1(kFl3ngrFlushThreshold));
+#else
+    return x;
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,2390 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Fl3ngrBands.hpp"
+#include "Fl3ngrDenormals.hpp"
+#include "Fl3ngrFastMath.hpp"
+#include "Fl3ngrOversampler.hpp"
+#include "Fl3ngrParameterQueue.hpp"
+#include "Fl3ngrProfiler.hpp"
+#include "Fl3ngrSimd.hpp"
+#include "Fl3ngrTelemetry.hpp"
+#include "Fl3ngrWorkers.hpp"
+
+// builds for ARM pedalboards and other small boards (`make EMBEDDED=true`) step the LFOs and crossover ramps
+// every 64 frames instead of every 16
+#ifndef FL3NGR_EMBEDDED
+# define FL3NGR_EMBEDDED 0
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Parameters
+//
+// The 3 band build keeps the order hvcc exposes the @hv_param receivers of WSTD_FL3NGR.pd in, then the native
+// engine's own, so sessions and automation made with earlier versions still find their parameters. Those sessions
+// have no Crossover value, its default of Classic plays them on the patch like they were made. Other band counts
+// list each band's controls in band order, then the shared ones.
+
+#if FL3NGR_BAND_COUNT == 3
+
+enum Fl3ngrParameters
+{
+    paramHigh,
+    paramHigh_Feedback,
+    paramHigh_Intensity,
+    paramHigh_Mix,
+    paramHigh_Speed,
+    paramLow,
+    paramLow_Feedback,
+    paramLow_Intensity,
+    paramLow_Mix,
+    paramLow_Speed,
+    paramMid,
+    paramMid_Feedback,
+    paramMid_Freq,
+    paramMid_Intensity,
+    paramMid_Mix,
+    paramMid_Speed,
+    paramCrossover,
+    paramSync,
+    paramHigh_Phase,
+    paramMid_Phase,
+    paramLow_Phase,
+    paramOversampling,
+    paramInterpolation,
+    paramHigh_Voices,
+    paramMid_Voices,
+    paramLow_Voices,
+    paramRender,
+    kFl3ngrParameterCount,
+    paramFreq = paramMid_Freq
+};
+
+// the parameters WSTD_FL3NGR.pd has an @hv_param receiver for, the Classic crossover hands them to the patch
+static const uint32_t kFl3ngrPatchParameterCount = paramCrossover;
+
+#else
+
+enum Fl3ngrParameters
+{
+    paramFreq = kFl3ngrBandCount * kBandPhase,
+    paramCrossover,
+    paramSync,
+    paramPhase,
+    paramOversampling = paramPhase + kFl3ngrBandCount,
+    paramInterpolation,
+    paramVoices,
+    paramRender = paramVoices + kFl3ngrBandCount,
+    kFl3ngrParameterCount
+};
+
+// there is no patch of other band counts, so no Classic crossover either
+static const uint32_t kFl3ngrPatchParameterCount = 0;
+
+#endif
+
+enum Fl3ngrCrossovers
+{
+    kCrossoverEq,
+    kCrossoverLR4,
+    kCrossoverClassic,
+    kFl3ngrCrossoverCount
+};
+
+static const char* const kFl3ngrCrossoverNames[kFl3ngrCrossoverCount] = { "EQ", "LR4", "Classic" };
+
+enum Fl3ngrSyncModes
+{
+    kSyncFree,
+    kSyncHost,
+    kFl3ngrSyncCount
+};
+
+static const char* const kFl3ngrSyncNames[kFl3ngrSyncCount] = { "Free", "Host" };
+
+enum Fl3ngrOversamplings
+{
+    kOversampling1x,
+    kOversampling2x,
+    kOversampling4x,
+    kFl3ngrOversamplingCount
+};
+
+static const char* const kFl3ngrOversamplingNames[kFl3ngrOversamplingCount] = { "1x", "2x", "4x" };
+
+enum Fl3ngrInterpolations
+{
+    kInterpolationLinear,
+    kInterpolationCubic,
+    kInterpolationLagrange,
+    kInterpolationAllpass,
+    kFl3ngrInterpolationCount
+};
+
+static const char* const kFl3ngrInterpolationNames[kFl3ngrInterpolationCount] = {
+    "Linear", "Cubic", "Lagrange", "Allpass"
+};
+
+// read taps a band's delay line can have, each a voice of its own in the ensemble
+static const uint32_t kFl3ngrMaxVoices = 4;
+
+static const char* const kFl3ngrVoicesNames[kFl3ngrMaxVoices] = { "1", "2", "3", "4" };
+
+// parallel builds render on more cores only while Render is on Offline, which only the user can tell: DPF hands
+// plugins no offline or freewheel flag of the host. Every build has the parameter, so builds that share a plugin id
+// share a parameter list, it is hidden and does nothing without FL3NGR_PARALLEL.
+enum Fl3ngrRenderModes
+{
+    kRenderRealtime,
+    kRenderOffline,
+    kFl3ngrRenderModeCount
+};
+
+static const char* const kFl3ngrRenderModeNames[kFl3ngrRenderModeCount] = { "Realtime", "Offline" };
+
+enum Fl3ngrParameterHints
+{
+    kFl3ngrHintLogarithmic = 1 << 0,
+    kFl3ngrHintChoice      = 1 << 1,
+    kFl3ngrHintHidden      = 1 << 2,
+};
+
+static const uint32_t kFl3ngrRenderHints = FL3NGR_PARALLEL ? kFl3ngrHintChoice : kFl3ngrHintChoice | kFl3ngrHintHidden;
+
+struct Fl3ngrParameterInfo
+{
+    const char* receiver;
+    const char* name;
+    const char* symbol;
+    const char* unit;
+    float min;
+    float max;
+    float def;
+    uint32_t hints;
+};
+
+#if FL3NGR_BAND_COUNT == 3
+
+static const Fl3ngrParameterInfo kFl3ngrParameters[kFl3ngrParameterCount] = {
+    { "High",           "High",           "high",           "dB",  -15.0f,   15.0f,    0.0f, 0 },
+    { "High_Feedback",  "High Feedback",  "high_feedback",  "%",  -100.0f,  100.0f,    0.0f, 0 },
+    { "High_Intensity", "High Intensity", "high_intensity", "%",     0.0f,  100.0f,   20.0f, 0 },
+    { "High_Mix",       "High Mix",       "high_mix",       "%",     0.0f,  100.0f,   50.0f, 0 },
+    { "High_Speed",     "High Speed",     "high_speed",     "Hz",    0.0f,   20.0f,    2.0f, 0 },
+    { "Low",            "Low",            "low",            "dB",  -15.0f,   15.0f,    0.0f, 0 },
+    { "Low_Feedback",   "Low Feedback",   "low_feedback",   "%",  -100.0f,  100.0f,    0.0f, 0 },
+    { "Low_Intensity",  "Low Intensity",  "low_intensity",  "%",     0.0f,  100.0f,   20.0f, 0 },
+    { "Low_Mix",        "Low Mix",        "low_mix",        "%",     0.0f,  100.0f,   50.0f, 0 },
+    { "Low_Speed",      "Low Speed",      "low_speed",      "Hz",    0.0f,   20.0f,    2.0f, 0 },
+    { "Mid",            "Mid",            "mid",            "dB",  -15.0f,   15.0f,    0.0f, 0 },
+    { "Mid_Feedback",   "Mid Feedback",   "mid_feedback",   "%",  -100.0f,  100.0f,    0.0f, 0 },
+    { "Mid_Freq",       "Mid Freq",       "mid_freq",       "Hz",  313.3f, 5705.6f, 1337.0f, kFl3ngrHintLogarithmic },
+    { "Mid_Intensity",  "Mid Intensity",  "mid_intensity",  "%",     0.0f,  100.0f,   20.0f, 0 },
+    { "Mid_Mix",        "Mid Mix",        "mid_mix",        "%",     0.0f,  100.0f,   50.0f, 0 },
+    { "Mid_Speed",      "Mid Speed",      "mid_speed",      "Hz",    0.0f,   20.0f,    2.0f, 0 },
+    { "Crossover",      "Crossover",      "crossover",      "",      0.0f,    2.0f,    2.0f, kFl3ngrHintChoice },
+    { "Sync",           "Sync",           "sync",           "",      0.0f,    1.0f,    0.0f, kFl3ngrHintChoice },
+    { "High_Phase",     "High Phase",     "high_phase",     "deg",   0.0f,  360.0f,    0.0f, 0 },
+    { "Mid_Phase",      "Mid Phase",      "mid_phase",      "deg",   0.0f,  360.0f,    0.0f, 0 },
+    { "Low_Phase",      "Low Phase",      "low_phase",      "deg",   0.0f,  360.0f,    0.0f, 0 },
+    { "Oversampling",   "Oversampling",   "oversampling",   "",      0.0f,    2.0f,    0.0f, kFl3ngrHintChoice },
+    { "Interpolation",  "Interpolation",  "interpolation",  "",      0.0f,    3.0f,    0.0f, kFl3ngrHintChoice },
+    { "High_Voices",    "High Voices",    "high_voices",    "",      1.0f,    4.0f,    1.0f, kFl3ngrHintChoice },
+    { "Mid_Voices",     "Mid Voices",     "mid_voices",     "",      1.0f,    4.0f,    1.0f, kFl3ngrHintChoice },
+    { "Low_Voices",     "Low Voices",     "low_voices",     "",      1.0f,    4.0f,    1.0f, kFl3ngrHintChoice },
+    { "Render",         "Render",         "render",         "",      0.0f,    1.0f,    0.0f, kFl3ngrRenderHints },
+};
+
+/**
+   Parameter index of one control of a band.
+ */
+static inline uint32_t fl3ngrBandParameter(uint32_t band, uint32_t control)
+{
+    static const uint8_t indices[kFl3ngrBandCount][kFl3ngrBandControlCount] = {
+        { paramHigh, paramHigh_Feedback, paramHigh_Intensity, paramHigh_Mix, paramHigh_Speed, paramHigh_Phase,
+          paramHigh_Voices },
+        { paramMid,  paramMid_Feedback,  paramMid_Intensity,  paramMid_Mix,  paramMid_Speed,  paramMid_Phase,
+          paramMid_Voices },
+        { paramLow,  paramLow_Feedback,  paramLow_Intensity,  paramLow_Mix,  paramLow_Speed,  paramLow_Phase,
+          paramLow_Voices },
+    };
+
+    return indices[band][control];
+}
+
+#else
+
+#define FL3NGR_BAND_PARAMETERS(receiver, name, symbol) \
+    { #receiver,               name,               #symbol,               "dB",   -15.0f,  15.0f,  0.0f, 0 }, \
+    { #receiver "_Feedback",   name " Feedback",   #symbol "_feedback",   "%",   -100.0f, 100.0f,  0.0f, 0 }, \
+    { #receiver "_Intensity",  name " Intensity",  #symbol "_intensity",  "%",      0.0f, 100.0f, 20.0f, 0 }, \
+    { #receiver "_Mix",        name " Mix",        #symbol "_mix",        "%",      0.0f, 100.0f, 50.0f, 0 }, \
+    { #receiver "_Speed",      name " Speed",      #symbol "_speed",      "Hz",     0.0f,  20.0f,  2.0f, 0 },
+
+#define FL3NGR_BAND_PHASE_PARAMETER(receiver, name, symbol) \
+    { #receiver "_Phase",      name " Phase",      #symbol "_phase",      "deg",    0.0f, 360.0f,  0.0f, 0 },
+
+#define FL3NGR_BAND_VOICES_PARAMETER(receiver, name, symbol) \
+    { #receiver "_Voices",     name " Voices",     #symbol "_voices",     "",       1.0f,   4.0f,  1.0f, \
+      kFl3ngrHintChoice },
+
+static const Fl3ngrParameterInfo kFl3ngrParameters[kFl3ngrParameterCount] = {
+    FL3NGR_BANDS(FL3NGR_BAND_PARAMETERS)
+    { "Freq",           "Freq",           "freq",           "Hz",  313.3f, 5705.6f, 1337.0f, kFl3ngrHintLogarithmic },
+    { "Crossover",      "Crossover",      "crossover",      "",      0.0f,    1.0f,    0.0f, kFl3ngrHintChoice },
+    { "Sync",           "Sync",           "sync",           "",      0.0f,    1.0f,    0.0f, kFl3ngrHintChoice },
+    FL3NGR_BANDS(FL3NGR_BAND_PHASE_PARAMETER)
+    { "Oversampling",   "Oversampling",   "oversampling",   "",      0.0f,    2.0f,    0.0f, kFl3ngrHintChoice },
+    { "Interpolation",  "Interpolation",  "interpolation",  "",      0.0f,    3.0f,    0.0f, kFl3ngrHintChoice },
+    FL3NGR_BANDS(FL3NGR_BAND_VOICES_PARAMETER)
+    { "Render",         "Render",         "render",         "",      0.0f,    1.0f,    0.0f, kFl3ngrRenderHints },
+};
+
+#undef FL3NGR_BAND_PARAMETERS
+#undef FL3NGR_BAND_PHASE_PARAMETER
+#undef FL3NGR_BAND_VOICES_PARAMETER
+
+static inline uint32_t fl3ngrBandParameter(uint32_t band, uint32_t control)
+{
+    switch (control)
+    {
+    case kBandPhase:  return paramPhase + band;
+    case kBandVoices: return paramVoices + band;
+    default:          return band * kBandPhase + control;
+    }
+}
+
+#endif
+
+// labels of a kFl3ngrHintChoice parameter, one per integer step of its range
+static inline const char* const* fl3ngrChoiceNames(uint32_t index)
+{
+    for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+        if (index == fl3ngrBandParameter(b, kBandVoices))
+            return kFl3ngrVoicesNames;
+
+    switch (index)
+    {
+    case paramCrossover:     return kFl3ngrCrossoverNames;
+    case paramSync:          return kFl3ngrSyncNames;
+    case paramOversampling:  return kFl3ngrOversamplingNames;
+    case paramInterpolation: return kFl3ngrInterpolationNames;
+    case paramRender:        return kFl3ngrRenderModeNames;
+    default:                 return nullptr;
+    }
+}
+
+// output parameters of the plugin after the regular ones: profiling counters, then the band meters
+static const uint32_t kFl3ngrTelemetryParameterOffset = kFl3ngrParameterCount + kFl3ngrProfileParameterCount;
+static const uint32_t kFl3ngrPluginParameterCount = kFl3ngrTelemetryParameterOffset + kFl3ngrTelemetryParameterCount;
+
+// --------------------------------------------------------------------------------------------------------------------
+// Biquad coefficients, the engine runs them in transposed direct form II
+
+struct Fl3ngrBiquadCoeffs
+{
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+    // no filtering, only a gain: 1 passes the input, 0 mutes it
+    void setGain(float gain)
+    {
+        b0 = gain;
+        b1 = b2 = a1 = a2 = 0.0f;
+    }
+
+    void setLowpass(double freq, double q, double sampleRate)
+    {
+        const double w0 = 2.0 * M_PI * std::min(freq, 0.45 * sampleRate) / sampleRate;
+        const double cw = std::cos(w0);
+        const double alpha = std::sin(w0) / (2.0 * q);
+        const double a0 = 1.0 + alpha;
+
+        b0 = static_cast<float>((1.0 - cw) * 0.5 / a0);
+        b1 = static_cast<float>((1.0 - cw) / a0);
+        b2 = b0;
+        a1 = static_cast<float>(-2.0 * cw / a0);
+        a2 = static_cast<float>((1.0 - alpha) / a0);
+    }
+
+    void setHighpass(double freq, double q, double sampleRate)
+    {
+        const double w0 = 2.0 * M_PI * std::min(freq, 0.45 * sampleRate) / sampleRate;
+        const double cw = std::cos(w0);
+        const double alpha = std::sin(w0) / (2.0 * q);
+        const double a0 = 1.0 + alpha;
+
+        b0 = static_cast<float>((1.0 + cw) * 0.5 / a0);
+        b1 = static_cast<float>(-(1.0 + cw) / a0);
+        b2 = b0;
+        a1 = static_cast<float>(-2.0 * cw / a0);
+        a2 = static_cast<float>((1.0 - alpha) / a0);
+    }
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// Butterworth state variable filter coefficients (trapezoidal), one state gives lowpass, bandpass and allpass
+
+struct Fl3ngrSvfCoeffs
+{
+    static constexpr double kDamping = 1.4142135623730951;
+
+    float a1 = 1.0f, a2 = 0.0f, a3 = 0.0f;
+
+    static double warp(double freq, double sampleRate)
+    {
+        return std::tan(M_PI * std::min(freq, 0.45 * sampleRate) / sampleRate);
+    }
+
+    void setWarped(double g)
+    {
+        a1 = static_cast<float>(1.0 / (1.0 + g * (g + kDamping)));
+        a2 = static_cast<float>(g / (1.0 + g * (g + kDamping)));
+        a3 = static_cast<float>(g * g / (1.0 + g * (g + kDamping)));
+    }
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// What the Classic crossover renders with, the hvcc context of WSTD_FL3NGR.pd (see Fl3ngrPatch.hpp). The engine
+// itself never includes the hvcc output, whoever owns the context hands it over with Fl3ngrEngineT::setPatch().
+
+class Fl3ngrPatchProcessor
+{
+public:
+    virtual ~Fl3ngrPatchProcessor() {}
+
+    // one of the first kFl3ngrPatchParameterCount parameters, from the audio thread
+    virtual void setParameter(uint32_t index, float value) = 0;
+
+    virtual void process(const float* inL, const float* inR, float* outL, float* outR, uint32_t frames) = 0;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// Multiband flanger engine
+//
+// Mirrors WSTD_FL3NGR.pd: `pd stereo_eq_pass` splits the input into high, mid and low bands with their dB gains,
+// each band runs through its own `hv.flanger2~ 20` and the bands are summed back together. The number of bands
+// and their crossover points come from Fl3ngrBands.hpp, the 3 band default is the patch.
+//
+// The band-channel pairs are processed as lanes of a four-wide vector type: crossover sections, gain, LFO,
+// delay interpolation, feedback and mix all run on whole vectors, only the per-lane delay reads are scalar.
+// Running bands are packed two per vector each chunk, so bands that are switched off cost nothing.
+// A band whose gain sits at full left fades out and stops, on re-enable its state is flushed before it fades back in.
+// Bands at 0% mix skip the modulated read and feedback, bands at 100% mix skip the dry path.
+//
+// Crossover modes:
+//  - EQ: every band filters the input with its own two Butterworth lowpass sections, at its upper and lower edge,
+//    and takes their difference. The top band uses the input itself for the upper one and the bottom band has
+//    no lower one, so with every flanger dry and every gain at 0 dB the bands sum back to the input exactly.
+//  - LR4: Linkwitz-Riley 4th order splits shared by all bands, from the lowest up. Each split point runs two
+//    Butterworth state variable filters, the lowpass comes from the second one and the highpass is the first one's
+//    allpass minus that lowpass. Every band below the top two is phase aligned through the allpasses of the splits
+//    above its own, so with every flanger dry and every gain at 0 dB the bands sum to a flat allpass of the input.
+//    For 3 bands that is five filters per channel instead of six biquads.
+//  - Classic: the patch itself, as hvcc compiles it, which is what versions built straight from hvcc ran. The whole
+//    block goes through the hvcc context set with setPatch(), every band always runs and the native engine's own
+//    settings (Sync, Phase, Oversampling, Interpolation, Voices) do nothing. The bands of the native crossovers stand
+//    still meanwhile apart from their LFOs, and start from silence when the crossover is switched back. Without a
+//    patch, as in builds of other band counts, Classic is EQ.
+//
+// Parameters may be set from any number of threads while another one processes. Each is stored in an atomic of
+// its own and flagged in a dirty mask, which process() takes once per block and applies the latest value of every
+// flagged parameter from, so a burst of changes costs one coefficient update. The crossover frequency moves
+// by interpolating from the current to the new coefficients every kRampSize frames, gain, mix, intensity and
+// feedback ramp linearly over the chunk that picks them up.
+//
+// The LFOs are evaluated every kRampSize frames and linearly interpolated in between. In host sync every band's
+// phase comes from one beat clock, times its speed snapped to a musical ratio, plus its phase offset. The embedded
+// control rate of one step per 64 frames puts the sweep at most 0.21% of its depth off the sine at 20 Hz and
+// 44.1 kHz (1.8 samples at full intensity), against 0.013% at 16 frames, and the error falls with the square of
+// the speed. Fast math builds turn the sine from edge to edge (see Fl3ngrFastMath.hpp).
+//
+// Oversampling runs the delay lines, their modulation and feedback at 2x or 4x the host rate, so fast sweeps and
+// high feedback stop aliasing. The crossover, gain and mix stay at the host rate: each band interpolates its
+// filtered input up, flanges and decimates the result back (see Fl3ngrOversampler.hpp). The dry path is delayed
+// by the same whole number of frames, which is reported as latency. Bands at 0% mix skip the filters.
+//
+// All delay lines live in one arena, each a power-of-two ring followed by a copy of its first few samples.
+// Reads mask their first tap and take the rest contiguously, whatever the interpolation, and at 1x the lines in
+// use fit in L1. Every line is written at the same position, so one index serves all of them. The arena holds
+// two sets of lines. A new factor takes effect once the set not in use has been cleared for it, kClearChunkFloats
+// per chunk, so a switch never clears hundreds of kilobytes within one block.
+// Linear interpolation reads two taps and dulls the top octave at fractional delays, cubic (Catmull-Rom) and
+// 3rd order Lagrange read four taps, the allpass keeps the magnitude flat but smears fast sweeps. The four tap
+// interpolators need one sample more at 1x, so they read one sample further back.
+//
+// A band can run up to kFl3ngrMaxVoices voices for chorus and ensemble textures: read taps on the one delay line,
+// each swept by the band's LFO shifted by an equal share of the cycle. The wet signal and the feedback are their
+// average. Every voice after the first costs one more interpolated read, the crossover, the line and its write are
+// shared. Running bands are grouped by voice count too, so a group rarely reads taps that one of its bands lacks.
+//
+// Once the input has stayed below kSilenceDb for longer than the longest tail of the settings since it went quiet,
+// every feedback loop and filter has rung out below that too and the engine sleeps: the delay lines and filter
+// states are cleared, blocks are answered with silence, only the LFOs, the beat clock and parameter changes move
+// on. The first block with input processes normally again, from silence, whatever the feedback is by then.
+//
+// Mono sources routed to both inputs would run every band's left and right lanes on the same samples. While the
+// inputs match bit for bit, each band runs its left channel only, so one vector holds four bands instead of two,
+// and both outputs get the left sum. The LFOs of both channels are the same, so this changes nothing audible.
+//
+// Past the crossover the groups of a chunk share nothing but their inputs until they are summed. With Render on
+// Offline, large blocks (setRenderThreads(), builds with FL3NGR_PARALLEL) hand them to worker threads, each group
+// with working buffers of its own, and sum them in the same order once all are done, so the output stays the same
+// bit for bit. Three stereo bands fill two vectors, so three bands use two threads at most, six bands three.
+//
+// The engine expects to run with flush-to-zero where the FPU has it (see Fl3ngrDenormals.hpp). Elsewhere every
+// feedback write, the allpass state and the crossover filter states at each kRampSize edge are flushed explicitly.
+
+template <class V>
+class Fl3ngrEngineT
+{
+public:
+    static constexpr uint32_t kBandCount = kFl3ngrBandCount;
+
+    static constexpr float kBandOffDb = -15.0f;
+    static constexpr double kFadeMs = 10.0;
+    static constexpr double kButterworthQ = 0.7071067811865476;
+    static constexpr double kMaxDelayMs = 20.0;
+    static constexpr uint32_t kChunkSize = 128;
+    static constexpr uint32_t kRampSize = FL3NGR_EMBEDDED ? 64 : 16;
+    static constexpr bool kQuadratureLfo = FL3NGR_FAST_MATH;
+    static constexpr double kCrossoverRampMs = 20.0;
+    static constexpr uint32_t kMaxOversampling = 4;
+    static constexpr uint32_t kLineGuard = 4;
+    static constexpr uint32_t kArenaAlign = 16;  // floats, one cache line
+    static constexpr uint32_t kClearChunkFloats = 8192;  // 32 KB of delay line
+    static constexpr double kSilenceDb = -120.0;
+    static constexpr double kCrossoverTailMs = 50.0;  // the lowest split rings out below kSilenceDb in about 20
+    static constexpr uint32_t kGroupCount = (kBandCount + 1) / 2;  // the most vectors a chunk fills
+    static constexpr uint32_t kParallelMinFrames = 1024;          // waking the workers costs about one chunk
+
+    static_assert(kFl3ngrParameterCount <= 64, "every parameter needs a bit of the dirty mask");
+
+    Fl3ngrEngineT()
+    {
+        for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+        {
+            fParameters[i].store(kFl3ngrParameters[i].def, std::memory_order_relaxed);
+            fParameterBands[i] = kBandCount;
+        }
+
+        for (uint32_t b = 0; b < kBandCount; ++b)
+        {
+            for (uint32_t c = 0; c < kFl3ngrBandControlCount; ++c)
+            {
+                fParameterBands[fl3ngrBandParameter(b, c)] = static_cast<uint8_t>(b);
+                fParameterControls[fl3ngrBandParameter(b, c)] = static_cast<uint8_t>(c);
+            }
+        }
+    }
+
+   /**
+      Allocate the delay lines and recompute the filters for a new sample rate.
+      Not realtime safe, call it while the engine is not processing.
+    */
+    void setSampleRate(double sampleRate)
+    {
+        fSampleRate = sampleRate;
+        fFadeStep = static_cast<float>(1.0 / (kFadeMs * 0.001 * sampleRate));
+        fMaxDelay = static_cast<float>(kMaxDelayMs * 0.001 * sampleRate);
+        fLineSize = static_cast<uint32_t>(fMaxDelay) + 4;
+        fCrossoverRampSteps = std::max(1u, static_cast<uint32_t>(kCrossoverRampMs * 0.001 * sampleRate / kRampSize));
+        fTelemetry.setSampleRate(sampleRate);
+
+        // room for two sets of the largest rings, laid out again for the active factor by layoutLines(). The one
+        // allocation of the engine, zeroed here so all of it is paged in before the first block, whatever factor
+        // that runs at.
+        fArena.assign(2 * setFloats(kOversampling4x) + kArenaAlign, 0.0f);
+
+        reset();
+    }
+
+   /**
+      Clear all audio state and jump every smoothed value to the stored parameters, including those set since the
+      last process() call. A state restored before activation so starts out whole, without ramping from the old one.
+      Not realtime safe, call it while the engine is not processing.
+    */
+    void reset()
+    {
+        // every flagged value is already among the stored ones
+        fDirty.store(0, std::memory_order_relaxed);
+        fResync.store(false, std::memory_order_relaxed);
+
+        for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+            applyParameter(i, fParameters[i].load(std::memory_order_relaxed));
+
+        fActiveOversampling = fOversampling;
+        fActiveInterpolation = fInterpolation;
+        fLineSet = 0;
+        layoutLines();
+
+        // both sets, the spare one is then ready for any factor
+        std::fill(fArena.begin(), fArena.end(), 0.0f);
+        fSpareCleared = setFloats(kOversampling4x);
+
+        for (Band& band : fBands)
+        {
+            band.reset();
+            band.phase = 0.0;
+            band.gain = band.targetGain;
+            band.mix = band.targetMix;
+            band.feedback = band.targetFeedback;
+            band.intensity = band.targetIntensity;
+            band.fade = band.enabled ? 1.0f : 0.0f;
+            band.running = band.enabled;
+            band.dirty = 0;
+        }
+
+        updateCrossover(false);
+        fCrossoverDirty = false;
+        fActiveCrossover = fCrossover;
+        fClockBeats = 0.0;
+        std::memset(fOversamplerPos, 0, sizeof(fOversamplerPos));
+        std::memset(fSplitState, 0, sizeof(fSplitState));
+        fTelemetry.clear();
+        fSilentFrames = 0;
+        fSilentTail = 0;
+        fSleeping = false;
+
+        // both channels start from the same cleared state, identical input can run mono from the first block
+        fMonoFrames = 0;
+        fMono = true;
+    }
+
+   /**
+      Render the Classic crossover with `patch`, nullptr for none. The patch is handed every parameter it has a
+      receiver for now, and each change from then on. Not realtime safe, call it while the engine is not processing.
+    */
+    void setPatch(Fl3ngrPatchProcessor* patch)
+    {
+        fPatch = patch;
+
+        if (fPatch != nullptr)
+            for (uint32_t i = 0; i < kFl3ngrPatchParameterCount; ++i)
+                fPatch->setParameter(i, fParameters[i].load(std::memory_order_relaxed));
+
+        fCrossover = crossoverMode(fParameters[paramCrossover].load(std::memory_order_relaxed));
+    }
+
+    float getParameter(uint32_t index) const
+    {
+        return index < kFl3ngrParameterCount ? fParameters[index].load(std::memory_order_relaxed) : 0.0f;
+    }
+
+   /**
+      Set a parameter, it takes effect at the start of the next process() call.
+      Safe to call from any number of threads while another one processes, hosts set parameters from their UI
+      thread and automate them from the audio thread.
+    */
+    void setParameter(uint32_t index, float value)
+    {
+        if (index >= kFl3ngrParameterCount)
+            return;
+
+        fParameters[index].store(value, std::memory_order_relaxed);
+        fDirty.fetch_or(uint64_t(1) << index, std::memory_order_release);
+    }
+
+   /**
+      Set every parameter at once, as a restored state does. The values take effect together at the start of one
+      process() call, which never sees only part of them, and the crossover is retargeted once.
+      Safe to call from one thread while another one processes, but only from one thread at a time.
+    */
+    void setParameters(const float* values)
+    {
+        // odd while the values are being written, the audio thread then leaves them for the next block
+        fRestoreVersion.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+            fParameters[i].store(values[i], std::memory_order_relaxed);
+
+        fRestoreVersion.fetch_add(1, std::memory_order_release);
+        fResync.store(true, std::memory_order_release);
+    }
+
+   /**
+      Host transport for the next process() call, from the audio thread.
+      While the host plays, the synced LFOs are placed by its beat position, otherwise they run on at the last tempo.
+    */
+    void setTransport(bool playing, double beats, double bpm)
+    {
+        fTransportPlaying = playing;
+        fTransportBeats = beats;
+        if (bpm > 0.0)
+            fTempo = bpm;
+    }
+
+   /**
+      Keep the threads to render the band groups of every chunk on up to `threads` threads, this one included, in
+      blocks of at least kParallelMinFrames while Render is on Offline. 1 renders on the calling thread only. The
+      output is the same bit for bit either way. Waiting on other threads can cost a dropout, so the user has to
+      turn it on for a bounce. Workers that found no work for a while wait on a semaphore and cost nothing. Starts or stops the worker threads,
+      call it while the engine is not processing. Builds without FL3NGR_PARALLEL always render on one thread.
+    */
+    void setRenderThreads(uint32_t threads)
+    {
+        const uint32_t workers = std::min(std::max(threads, 1u), kGroupCount) - 1;
+        if (workers != fWorkers.size())
+            fWorkers.start(workers);
+    }
+
+    uint32_t getRenderThreads() const
+    {
+        return fWorkers.size() + 1;
+    }
+
+   /**
+      Let bands parked at 0% or 100% mix skip the path they do not hear, the default. Off, they run the kernel of any
+      other mix, which renders the same output: the bench checks the two against each other.
+    */
+    void setShortCircuit(bool shortCircuit)
+    {
+        fShortCircuit = shortCircuit;
+    }
+
+    bool isBandRunning(uint32_t band) const
+    {
+        return band < kBandCount && fBands[band].running;
+    }
+
+   /**
+      Bytes of the delay line arena, two sets of lines sized by setSampleRate() for 4x oversampling.
+    */
+    size_t getArenaBytes() const
+    {
+        return fArena.size() * sizeof(float);
+    }
+
+   /**
+      Bytes of the arena the delay lines take at an oversampling setting, kOversampling1x to kOversampling4x.
+    */
+    size_t getLineBytes(int oversampling) const
+    {
+        return setFloats(oversampling) * sizeof(float);
+    }
+
+   /**
+      Frames the output lags the input by, nonzero while oversampling.
+      A new factor takes effect in process(), check this after it.
+    */
+    uint32_t getLatency() const
+    {
+        return fActiveCrossover == kCrossoverClassic ? 0 : oversamplingLatency(fActiveOversampling);
+    }
+
+   /**
+      Frames the output takes to fall kSilenceDb below a full scale input after the input stops, for the current
+      settings: the slowest feedback loop of a band that is on, starting from that band's gain, then the
+      crossover ringing out and the oversampler latency.
+    */
+    uint32_t getTailFrames() const
+    {
+        double tail = 0.0;
+
+        for (const Band& band : fBands)
+        {
+            if (! band.enabled && ! band.running)
+                continue;
+
+            const double loop = 1.0 + band.targetIntensity * fMaxDelay;
+            const double decayDb = -kSilenceDb + 20.0 * std::log10(std::max(band.targetGain, 1.0f));
+            const double feedback = std::fabs(band.targetFeedback);
+            const double passes = feedback > 0.0 ? 1.0 + decayDb / (-20.0 * std::log10(feedback)) : 1.0;
+            tail = std::max(tail, passes * loop);
+        }
+
+        return static_cast<uint32_t>(std::ceil(tail + kCrossoverTailMs * 0.001 * fSampleRate))
+             + oversamplingLatency(fOversampling);
+    }
+
+    bool isSleeping() const
+    {
+        return fSleeping;
+    }
+
+   /**
+      True while the inputs are identical and the bands run one channel, see detectMono().
+    */
+    bool isMono() const
+    {
+        return fMono;
+    }
+
+    void process(const float* inL, const float* inR, float* outL, float* outR, uint32_t frames)
+    {
+        fProfiler.begin();
+
+        applyChangedParameters();
+
+        // one clock for every band, so a relocated transport puts all of them back at the same phases
+        if (fSync == kSyncHost && fTransportPlaying)
+            fClockBeats = fTransportBeats;
+        fTransportPlaying = false;
+
+        if (fCrossover == kCrossoverClassic)
+        {
+            processPatch(inL, inR, outL, outR, frames);
+            fProfiler.end(frames);
+            return;
+        }
+
+        if (skipSilence(inL, inR, frames))
+        {
+            std::memset(outL, 0, sizeof(float) * frames);
+            std::memset(outR, 0, sizeof(float) * frames);
+            fProfiler.end(frames);
+            return;
+        }
+
+        detectMono(inL, inR, frames);
+
+        fParallel = fRender == kRenderOffline && fWorkers.size() > 0 && frames >= kParallelMinFrames;
+        if (fParallel)
+            fWorkers.wake();
+        fProfiler.mark(kProfileParameters);
+
+        for (uint32_t pos = 0; pos < frames; pos += kChunkSize)
+            processChunk(inL + pos, inR + pos, outL + pos, outR + pos, std::min(kChunkSize, frames - pos));
+
+        if (fParallel)
+            fWorkers.sleep();
+
+        fProfiler.end(frames);
+    }
+
+   /**
+      Stage timings of a FL3NGR_PROFILE build, read them from one thread with Fl3ngrProfileCounters.
+    */
+    Fl3ngrProfiler& getProfiler()
+    {
+        return fProfiler;
+    }
+
+   /**
+      Band meters, take their records on the thread that processes, after process().
+    */
+    Fl3ngrTelemetry& getTelemetry()
+    {
+        return fTelemetry;
+    }
+
+private:
+    enum MixModes
+    {
+        kMixDry,
+        kMixWet,
+        kMixBlend
+    };
+
+    struct Band
+    {
+        Fl3ngrBiquadCoeffs sections[2];
+        Fl3ngrBiquadCoeffs targetSections[2];
+        Fl3ngrBiquadCoeffs sectionSteps[2];
+        float state[2][2][2] = {};  // [channel][section][z1, z2]
+        float* lines[2] = {};         // ring plus guard in the engine's arena
+        uint32_t lineLength = 0;
+        float allpass[kFl3ngrMaxVoices][2] = {};  // last output of each voice's allpass interpolator
+        float history[kFl3ngrOversamplerHistorySize][2] = {};  // oversampler rings, [sample][channel]
+        double phase = 0.0;
+        double phaseInc = 0.0;
+        double syncRatio = 1.0;
+        double phaseOffset = 0.0;
+        float mix = 0.5f;
+        float targetMix = 0.5f;
+        float feedback = 0.0f;
+        float targetFeedback = 0.0f;
+        float intensity = 0.2f;
+        float targetIntensity = 0.2f;
+        float gain = 1.0f;
+        float targetGain = 1.0f;
+        float fade = 1.0f;
+        uint32_t voices = 1;
+        uint32_t dirty = 0;  // floats at the start of the lines still to clear since the band stopped
+        bool enabled = true;
+        bool running = true;
+
+        // the lines are cleared apart, see clearLines(), and the LFO runs on while the band is off
+        void reset()
+        {
+            std::memset(state, 0, sizeof(state));
+            std::memset(allpass, 0, sizeof(allpass));
+            std::memset(history, 0, sizeof(history));
+        }
+
+        void resetDelay()
+        {
+            for (float* line : lines)
+                if (line != nullptr)
+                    std::fill(line, line + lineLength, 0.0f);
+            std::memset(allpass, 0, sizeof(allpass));
+            std::memset(history, 0, sizeof(history));
+            dirty = 0;
+        }
+
+        // both lines are left to clearLines(), they sit back to back
+        void stop()
+        {
+            fade = 0.0f;
+            running = false;
+            dirty = 2 * lineLength;
+        }
+
+        // the short-circuited modes only apply when the mix neither is nor ends up anywhere else this chunk
+        int mixMode() const
+        {
+            if (mix <= 0.0f && targetMix <= 0.0f)
+                return kMixDry;
+            if (mix >= 1.0f && targetMix >= 1.0f)
+                return kMixWet;
+            return kMixBlend;
+        }
+
+        // bands that share a vector best share a mix mode, then a voice count
+        uint32_t groupKey() const
+        {
+            return static_cast<uint32_t>(mixMode()) * kFl3ngrMaxVoices + voices - 1;
+        }
+    };
+
+    // per-lane working copy of up to two stereo or four mono bands, lane = band * channels + channel
+    struct Lanes
+    {
+        float coeffs[2][5][4];  // [section][b0 b1 b2 a1 a2][lane]
+        float coeffSteps[2][5][4];
+        uint32_t coeffRampSteps;
+        float state[2][2][4];   // [section][z1 z2][lane]
+        float phase[4], phaseInc[4];
+        float depth[4], depthStep[4], feedback[4], feedbackStep[4], mix[4], mixStep[4];
+        float gain[4], gainStep[4], fade[4], fadeStep[4];
+        float* lines[4];
+        float allpass[kFl3ngrMaxVoices][4];
+        uint32_t voices;                           // most voices of a band in the group
+        float voicePhase[kFl3ngrMaxVoices][4];     // LFO offset of each voice, in cycles
+        float voiceWeight[kFl3ngrMaxVoices][4];    // its share of the wet signal, 0 past the band's own count
+        float* out;                                // the group's output, [frame][lane]
+        float (*history)[4];                       // the group's oversampler rings, [sample][lane]
+    };
+
+    // the bands of one vector and everything their kernel writes, so the groups of a chunk can run on other threads
+    struct Group
+    {
+        Band* bands[4];
+        uint32_t count;
+        uint32_t channels;
+        uint32_t frames;
+        uint32_t rampSteps;
+        double beatsPerFrame;
+        Lanes lanes;
+        float in[kChunkSize * 4];
+        float out[kChunkSize * 4];
+        float history[kFl3ngrOversamplerHistorySize][4];
+        float peak[4], squares[4];  // the meters of each lane
+    };
+
+    static float clampUnit(float value)
+    {
+        return std::max(0.0f, std::min(1.0f, value));
+    }
+
+    void applyChangedParameters()
+    {
+        // a parameter set again after this picks its flag up again, for the next block
+        for (uint64_t dirty = fDirty.exchange(0, std::memory_order_acquire); dirty != 0; dirty &= dirty - 1)
+        {
+            const uint32_t index = fl3ngrLowestBit(dirty);
+            applyParameter(index, fParameters[index].load(std::memory_order_relaxed));
+        }
+
+        if (fResync.exchange(false, std::memory_order_acquire))
+        {
+            float values[kFl3ngrParameterCount];
+            const uint32_t version = fRestoreVersion.load(std::memory_order_acquire);
+
+            for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+                values[i] = fParameters[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // a state setParameters() is still writing waits for the next block, so it applies whole
+            if ((version & 1) != 0 || fRestoreVersion.load(std::memory_order_relaxed) != version)
+                fResync.store(true, std::memory_order_relaxed);
+            else
+                for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+                    applyParameter(i, values[i]);
+        }
+
+        // however many crossover frequency changes came in, the crossover is retargeted once
+        if (fCrossoverDirty)
+        {
+            updateCrossover(true);
+            fCrossoverDirty = false;
+        }
+    }
+
+    void applyParameter(uint32_t index, float value)
+    {
+        if (index < kFl3ngrPatchParameterCount && fPatch != nullptr)
+            fPatch->setParameter(index, value);
+
+        if (fParameterBands[index] < kBandCount)
+        {
+            Band& band(fBands[fParameterBands[index]]);
+
+            switch (fParameterControls[index])
+            {
+            case kBandGain:      setBandGain(band, value); break;
+            case kBandFeedback:  setBandFeedback(band, value); break;
+            case kBandIntensity: band.targetIntensity = clampUnit(value / 100.0f); break;
+            case kBandMix:       band.targetMix = clampUnit(value / 100.0f); break;
+            case kBandSpeed:     setBandSpeed(band, value); break;
+            case kBandPhase:     band.phaseOffset = value / 360.0; break;
+            case kBandVoices:    setBandVoices(band, value); break;
+            }
+            return;
+        }
+
+        switch (index)
+        {
+        case paramFreq:          fCrossoverDirty = true; break;
+        case paramCrossover:     fCrossover = crossoverMode(value); break;
+        case paramSync:          fSync = value >= 0.5f ? kSyncHost : kSyncFree; break;
+        case paramOversampling:  fOversampling = std::max(0, std::min(2, static_cast<int>(value + 0.5f))); break;
+        case paramInterpolation: fInterpolation = std::max(0, std::min(3, static_cast<int>(value + 0.5f))); break;
+        case paramRender:        fRender = value >= 0.5f ? kRenderOffline : kRenderRealtime; break;
+        }
+    }
+
+    int crossoverMode(float value) const
+    {
+        if (value >= 1.5f)
+            return fPatch != nullptr ? kCrossoverClassic : kCrossoverEq;
+        return value >= 0.5f ? kCrossoverLR4 : kCrossoverEq;
+    }
+
+   /**
+      Render a block of the Classic crossover with the patch. Its tails are its own, so the engine never sleeps
+      meanwhile. The bands stop like switched off ones, a native crossover wakes them from silence.
+    */
+    void processPatch(const float* inL, const float* inR, float* outL, float* outR, uint32_t frames)
+    {
+        // the meters are the native bands', they read silence while the patch plays
+        if (fActiveCrossover != kCrossoverClassic)
+        {
+            fTelemetry.clear();
+            publishTelemetry();
+        }
+
+        fActiveCrossover = kCrossoverClassic;
+        fSilentFrames = 0;
+        fSleeping = false;
+
+        fPatch->process(inL, inR, outL, outR, frames);
+        fProfiler.mark(kProfileCrossover);
+
+        for (Band& band : fBands)
+            if (band.running)
+                band.stop();
+
+        moveOn(frames);
+        fProfiler.mark(kProfileParameters);
+    }
+
+   /**
+      Count silent input and decide whether this block can be skipped, true while the engine sleeps.
+    */
+    bool skipSilence(const float* inL, const float* inR, uint32_t frames)
+    {
+        static const float threshold = static_cast<float>(std::pow(10.0, kSilenceDb / 20.0));
+
+        float peak = 0.0f;
+        for (uint32_t i = 0; i < frames; ++i)
+            peak = std::max(peak, std::max(std::fabs(inL[i]), std::fabs(inR[i])));
+
+        if (peak > threshold)
+        {
+            fSilentFrames = 0;
+            fSleeping = false;
+            return false;
+        }
+
+        if (! fSleeping)
+        {
+            // the longest tail since the input went quiet, turning the feedback down meanwhile doesn't cut off
+            // what the higher feedback left ringing in the lines
+            fSilentTail = std::max(fSilentFrames != 0 ? fSilentTail : 0u, getTailFrames());
+
+            // counted up to the tail, so a long silence cannot wrap around
+            fSilentFrames = std::min(fSilentFrames + frames, fSilentTail);
+            if (fSilentFrames < fSilentTail)
+                return false;
+            fSleeping = true;
+            clearAudioState();
+
+            // the meters drop to silence and stay there until the input comes back
+            fTelemetry.clear();
+            publishTelemetry();
+        }
+
+        moveOn(frames);
+        return true;
+    }
+
+   /**
+      Move on what time moves on for a block the bands don't process, like processing silence would, and land every
+      ramp on its target.
+    */
+    void moveOn(uint32_t frames)
+    {
+        const double beatsPerFrame = fTempo / (60.0 * fSampleRate);
+        fClockBeats += beatsPerFrame * frames;
+
+        for (Band& band : fBands)
+        {
+            band.phase = std::fmod(band.phase + band.phaseInc * frames, 1.0);
+            band.gain = band.targetGain;
+            band.mix = band.targetMix;
+            band.feedback = band.targetFeedback;
+            band.intensity = band.targetIntensity;
+
+            // a band switched off has faded by now, one switched on wakes up in processChunk()
+            if (! band.enabled && band.running)
+                band.stop();
+        }
+
+        if (fCrossoverStepsLeft != 0)
+            updateCrossover(false);
+
+        clearLines(frames);
+    }
+
+   /**
+      Zero what is left below kSilenceDb in the delay lines and filters as the engine goes to sleep, so nothing of it
+      comes back through feedback turned up during the silence. Both channels then hold the same state, mono input
+      runs one channel from the first block.
+    */
+    void clearAudioState()
+    {
+        for (Band& band : fBands)
+        {
+            std::memset(band.state, 0, sizeof(band.state));
+            band.resetDelay();
+        }
+
+        std::memset(fOversamplerPos, 0, sizeof(fOversamplerPos));
+        std::memset(fSplitState, 0, sizeof(fSplitState));
+        fMonoFrames = 0;
+        fMono = true;
+    }
+
+    void setBandGain(Band& band, float db)
+    {
+        band.enabled = db > kBandOffDb;
+        band.targetGain = band.enabled ? fl3ngrDbToGain(db) : 0.0f;
+    }
+
+    void setBandFeedback(Band& band, float value)
+    {
+        // kept just inside unity so a fully open loop cannot run away
+        band.targetFeedback = std::max(-0.98f, std::min(0.98f, value / 100.0f));
+    }
+
+    void setBandSpeed(Band& band, float speed)
+    {
+        band.phaseInc = fSampleRate > 0.0 ? speed / fSampleRate : 0.0;
+        band.syncRatio = syncRatio(speed);
+    }
+
+    void setBandVoices(Band& band, float voices)
+    {
+        band.voices = std::max(1u, std::min(kFl3ngrMaxVoices, static_cast<uint32_t>(voices + 0.5f)));
+    }
+
+   /**
+      Whole host frames through the oversampler. Every half-band stage delays by its centre tap, the decimators
+      keep the phase that makes the total a whole number of frames.
+    */
+    static uint32_t oversamplingFactor(int oversampling)
+    {
+        return 1u << oversampling;
+    }
+
+    static uint32_t oversamplingLatency(int oversampling)
+    {
+        switch (oversampling)
+        {
+        case kOversampling2x: return 23;
+        case kOversampling4x: return 27;
+        default:              return 0;
+        }
+    }
+
+   /**
+      LFO cycles per beat in host sync. Speed reads as Hz at 120 bpm, snapped to the nearest musical division.
+    */
+    static double syncRatio(float speed)
+    {
+        static const double divisions[] = {
+            1.0 / 16, 1.0 / 12, 1.0 / 8, 1.0 / 6, 1.0 / 4, 1.0 / 3, 1.0 / 2, 2.0 / 3,
+            1.0, 3.0 / 2, 2.0, 3.0, 4.0, 6.0, 8.0
+        };
+
+        if (speed <= 0.0f)
+            return 0.0;
+
+        const double cyclesPerBeat = speed / 2.0;
+        double best = divisions[0];
+        for (double d : divisions)
+            if (std::fabs(std::log(d / cyclesPerBeat)) < std::fabs(std::log(best / cyclesPerBeat)))
+                best = d;
+        return best;
+    }
+
+   /**
+      Compute the crossover for the current crossover frequency, either in place or as a target that stepCrossover()
+      moves towards over fCrossoverRampSteps steps.
+      Butterworth sections are stable anywhere on the straight line between two stable coefficient sets, so the
+      biquads interpolate their coefficients directly, the state variable filters interpolate their warped cutoff.
+    */
+    void updateCrossover(bool ramp)
+    {
+        if (fSampleRate <= 0.0)
+            return;
+
+        // neighbouring bands meet at each split, for 3 bands an octave below and above Mid Freq
+        const double freq = fParameters[paramFreq].load(std::memory_order_relaxed);
+        double splits[kSplitCount];
+
+        for (uint32_t j = 0; j < kSplitCount; ++j)
+        {
+            splits[j] = fl3ngrSplitFrequency(j, freq);
+            fSplitTargetG[j] = Fl3ngrSvfCoeffs::warp(splits[j], fSampleRate);
+        }
+
+        // each band is the lowpass at its upper edge minus the one at its lower edge, the top band has the input
+        // in place of the first and the bottom band nothing in place of the second
+        for (uint32_t b = 0; b < kBandCount; ++b)
+        {
+            Fl3ngrBiquadCoeffs* const sections = fBands[b].targetSections;
+
+            if (b == 0)
+                sections[0].setGain(1.0f);
+            else
+                sections[0].setLowpass(splits[b - 1], kButterworthQ, fSampleRate);
+
+            if (b == kBandCount - 1)
+                sections[1].setGain(0.0f);
+            else
+                sections[1].setLowpass(splits[b], kButterworthQ, fSampleRate);
+        }
+
+        if (! ramp)
+        {
+            fCrossoverStepsLeft = 0;
+            for (Band& band : fBands)
+                for (int n = 0; n < 2; ++n)
+                    band.sections[n] = band.targetSections[n];
+            for (uint32_t j = 0; j < kSplitCount; ++j)
+            {
+                fSplitG[j] = fSplitTargetG[j];
+                fSplits[j].setWarped(fSplitG[j]);
+            }
+            return;
+        }
+
+        // a new target mid-ramp starts from wherever the coefficients are now
+        const float steps = static_cast<float>(fCrossoverRampSteps);
+        fCrossoverStepsLeft = fCrossoverRampSteps;
+
+        for (Band& band : fBands)
+        {
+            for (int n = 0; n < 2; ++n)
+            {
+                const Fl3ngrBiquadCoeffs& from(band.sections[n]);
+                const Fl3ngrBiquadCoeffs& to(band.targetSections[n]);
+                Fl3ngrBiquadCoeffs& step(band.sectionSteps[n]);
+
+                step.b0 = (to.b0 - from.b0) / steps;
+                step.b1 = (to.b1 - from.b1) / steps;
+                step.b2 = (to.b2 - from.b2) / steps;
+                step.a1 = (to.a1 - from.a1) / steps;
+                step.a2 = (to.a2 - from.a2) / steps;
+            }
+        }
+
+        for (uint32_t j = 0; j < kSplitCount; ++j)
+            fSplitGStep[j] = (fSplitTargetG[j] - fSplitG[j]) / fCrossoverRampSteps;
+    }
+
+   /**
+      Advance the stored crossover by one ramp step, the kernels make the same steps on their own copies.
+      The last step lands exactly on the target, so rounding never leaves the filters off by a bit.
+    */
+    void stepCrossover()
+    {
+        const bool last = --fCrossoverStepsLeft == 0;
+
+        for (Band& band : fBands)
+        {
+            for (int n = 0; n < 2; ++n)
+            {
+                Fl3ngrBiquadCoeffs& c(band.sections[n]);
+                const Fl3ngrBiquadCoeffs& step(band.sectionSteps[n]);
+
+                if (last)
+                {
+                    c = band.targetSections[n];
+                    continue;
+                }
+
+                c.b0 += step.b0;
+                c.b1 += step.b1;
+                c.b2 += step.b2;
+                c.a1 += step.a1;
+                c.a2 += step.a2;
+            }
+        }
+
+        for (uint32_t j = 0; j < kSplitCount; ++j)
+        {
+            fSplitG[j] = last ? fSplitTargetG[j] : fSplitG[j] + fSplitGStep[j];
+            fSplits[j].setWarped(fSplitG[j]);
+        }
+    }
+
+    static void runSvf(const V& x, V& ic1, V& ic2, const V& a1, const V& a2, const V& a3, V& lp, V& bp)
+    {
+        const V two = V::set1(2.0f);
+        const V v3 = x - ic2;
+        const V v1 = a1 * ic1 + a2 * v3;
+        const V v2 = ic2 + a2 * ic1 + a3 * v3;
+        ic1 = two * v1 - ic1;
+        ic2 = two * v2 - ic2;
+        lp = v2;
+        bp = v1;
+    }
+
+   /**
+      First of the state variable filters that phase align band `band` (2 or lower) through the splits above its own.
+    */
+    static constexpr uint32_t compensationFilter(uint32_t band)
+    {
+        return 2 * kSplitCount + (band - 1) * (band - 2) / 2;
+    }
+
+   /**
+      LR4 band split of a whole chunk into fSplit, lanes hold L, R, L, R like fLaneIn.
+      Every loop runs to a band count known at compile time, so they unroll and the filter states stay in registers.
+      The phase compensation of a band only runs while that band does.
+    */
+    void processSplit(uint32_t frames, uint32_t rampSteps)
+    {
+        const V twoK = V::set1(static_cast<float>(2.0 * Fl3ngrSvfCoeffs::kDamping));
+        V a1[kSplitCount], a2[kSplitCount], a3[kSplitCount];
+        bool compensate[kBandCount];
+
+        // local copy of the ramp, stepped exactly like stepCrossover() does after the chunk
+        double g[kSplitCount];
+        uint32_t stepsLeft = fCrossoverStepsLeft;
+
+        for (uint32_t j = 0; j < kSplitCount; ++j)
+        {
+            a1[j] = V::set1(fSplits[j].a1);
+            a2[j] = V::set1(fSplits[j].a2);
+            a3[j] = V::set1(fSplits[j].a3);
+            g[j] = fSplitG[j];
+        }
+
+        for (uint32_t b = 0; b < kBandCount; ++b)
+            compensate[b] = fBands[b].running;
+
+        V ic[kSplitFilterCount][2];
+        for (uint32_t f = 0; f < kSplitFilterCount; ++f)
+        {
+            ic[f][0] = V::load(fSplitState[f][0]);
+            ic[f][1] = V::load(fSplitState[f][1]);
+        }
+
+        for (uint32_t start = 0, step = 0; start < frames; start += kRampSize, ++step)
+        {
+            if (step < rampSteps)
+            {
+                const bool last = --stepsLeft == 0;
+
+                for (uint32_t j = 0; j < kSplitCount; ++j)
+                {
+                    Fl3ngrSvfCoeffs c;
+                    g[j] = last ? fSplitTargetG[j] : g[j] + fSplitGStep[j];
+                    c.setWarped(g[j]);
+                    a1[j] = V::set1(c.a1);
+                    a2[j] = V::set1(c.a2);
+                    a3[j] = V::set1(c.a3);
+                }
+            }
+
+            for (uint32_t f = 0; f < kSplitFilterCount; ++f)
+            {
+                ic[f][0] = fl3ngrFlushDenormals(ic[f][0]);
+                ic[f][1] = fl3ngrFlushDenormals(ic[f][1]);
+            }
+
+            const uint32_t end = std::min(start + kRampSize, frames);
+
+            for (uint32_t i = start; i < end; ++i)
+            {
+                V rest = V::load(fLaneIn + 4 * i);
+                V bands[kBandCount];
+
+                // from the lowest split up: 4th order lowpass for the band below, the rest is the allpass minus it
+                for (uint32_t j = kSplitCount; j-- > 0;)
+                {
+                    V lp, bp;
+                    runSvf(rest, ic[2 * j][0], ic[2 * j][1], a1[j], a2[j], a3[j], lp, bp);
+                    const V ap = rest - twoK * bp;
+                    runSvf(lp, ic[2 * j + 1][0], ic[2 * j + 1][1], a1[j], a2[j], a3[j], bands[j + 1], bp);
+                    rest = ap - bands[j + 1];
+                }
+
+                rest.store(fSplit[0] + 4 * i);
+                bands[1].store(fSplit[1] + 4 * i);
+
+                for (uint32_t b = 2; b < kBandCount; ++b)
+                {
+                    if (! compensate[b])
+                        continue;
+
+                    // through the allpass of every split above this band's own, lowest first
+                    V y = bands[b];
+                    for (uint32_t j = b - 1, f = compensationFilter(b); j-- > 0; ++f)
+                    {
+                        V lp, bp;
+                        runSvf(y, ic[f][0], ic[f][1], a1[j], a2[j], a3[j], lp, bp);
+                        y = y - twoK * bp;
+                    }
+                    y.store(fSplit[b] + 4 * i);
+                }
+            }
+        }
+
+        for (uint32_t f = 0; f < kSplitFilterCount; ++f)
+        {
+            ic[f][0].store(fSplitState[f][0]);
+            ic[f][1].store(fSplitState[f][1]);
+        }
+    }
+
+   /**
+      Track whether both inputs carry the same signal, the bands then run only their left channel and both outputs
+      get it. Mono starts once the inputs have matched for longer than the tail, by then the right channel's state
+      has rung into the left's. The first block that differs goes back to stereo, handing the right channel a copy of
+      the left's state, which is what it would hold had it run all along. So neither way clicks.
+    */
+    void detectMono(const float* inL, const float* inR, uint32_t frames)
+    {
+        if (std::memcmp(inL, inR, sizeof(float) * frames) != 0)
+        {
+            if (fMono)
+                leaveMono();
+            fMonoFrames = 0;
+            fMono = false;
+            return;
+        }
+
+        if (fMono)
+            return;
+
+        // counted up to the tail like fSilentFrames
+        const uint32_t tail = getTailFrames();
+        fMonoFrames = std::min(fMonoFrames + frames, tail);
+        fMono = fMonoFrames >= tail;
+    }
+
+    void leaveMono()
+    {
+        for (Band& band : fBands)
+        {
+            // a band that is not running starts over when it wakes up
+            if (! band.running)
+                continue;
+
+            std::memcpy(band.state[1], band.state[0], sizeof(band.state[0]));
+            std::memcpy(band.lines[1], band.lines[0], sizeof(float) * band.lineLength);
+            for (float* a : band.allpass)
+                a[1] = a[0];
+            for (float* h : band.history)
+                h[1] = h[0];
+        }
+    }
+
+    void resetCrossoverState()
+    {
+        for (Band& band : fBands)
+            std::memset(band.state, 0, sizeof(band.state));
+        std::memset(fSplitState, 0, sizeof(fSplitState));
+    }
+
+    void processChunk(const float* inL, const float* inR, float* outL, float* outR, uint32_t frames)
+    {
+        Band* running[kBandCount];
+        uint32_t count = 0;
+
+        // switching topology starts the new one from silence rather than from the other one's state
+        if (fActiveCrossover != fCrossover)
+        {
+            resetCrossoverState();
+            fActiveCrossover = fCrossover;
+        }
+
+        // at another rate the lines would hold other delays, they start over on the spare set once it is cleared
+        clearLines(frames);
+
+        // the allpass state only means something to the allpass
+        if (fActiveInterpolation != fInterpolation)
+        {
+            fActiveInterpolation = fInterpolation;
+            for (Band& band : fBands)
+                std::memset(band.allpass, 0, sizeof(band.allpass));
+        }
+
+        for (Band& band : fBands)
+        {
+            if (! band.running)
+            {
+                // one that stopped a moment ago waits for clearLines() to finish its lines. Its LFO moves on
+                // meanwhile, so it comes back where it would be had it never been off
+                if (! band.enabled || band.dirty != 0)
+                {
+                    band.phase = std::fmod(band.phase + band.phaseInc * frames, 1.0);
+                    continue;
+                }
+
+                // waking up: start from clean filter and delay state, then fade in
+                const uint32_t b = static_cast<uint32_t>(&band - fBands);
+                band.reset();
+                if (b >= 2)
+                    std::memset(fSplitState[compensationFilter(b)], 0, (b - 1) * sizeof(fSplitState[0]));
+                band.gain = band.targetGain;
+                band.running = true;
+            }
+            running[count++] = &band;
+        }
+
+        // group bands by mix mode, so bands parked at 0% or 100% can share a short-circuited vector, then by voice
+        // count. Sorted by insertion, which keeps their order within a key like std::stable_sort without the buffer
+        // that one allocates
+        for (uint32_t i = 1; i < count; ++i)
+            for (uint32_t j = i; j > 0 && running[j - 1]->groupKey() > running[j]->groupKey(); --j)
+                std::swap(running[j - 1], running[j]);
+
+        // mono lanes all take the left input, the LR4 split then runs the right channel's filters on it too
+        const float* const laneR = fMono ? inL : inR;
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            fLaneIn[4 * i + 0] = fLaneIn[4 * i + 2] = inL[i];
+            fLaneIn[4 * i + 1] = fLaneIn[4 * i + 3] = laneR[i];
+        }
+
+        const double beatsPerFrame = fTempo / (60.0 * fSampleRate);
+        if (fSync == kSyncHost)
+        {
+            for (uint32_t b = 0; b < count; ++b)
+            {
+                Band& band(*running[b]);
+                const double phase = fClockBeats * band.syncRatio + band.phaseOffset;
+                band.phase = phase - std::floor(phase);
+            }
+        }
+        fClockBeats += beatsPerFrame * frames;
+
+        // a moving crossover steps its coefficients at the start of every kRampSize frames
+        const uint32_t rampSteps = std::min(fCrossoverStepsLeft, (frames + kRampSize - 1) / kRampSize);
+
+        if (fActiveCrossover == kCrossoverLR4)
+            processSplit(frames, rampSteps);
+
+        fProfiler.mark(kProfileCrossover);
+
+        std::memset(fSumL, 0, sizeof(float) * frames);
+        std::memset(fSumR, 0, sizeof(float) * frames);
+        fProfiler.mark(kProfileSum);
+
+        // a vector holds two bands in stereo, four in mono. Offline blocks run the groups side by side and sum them
+        // in the same order after, which gives the same output bit for bit
+        const uint32_t channels = fMono ? 1 : 2;
+        uint32_t groups = 0;
+        for (uint32_t b = 0; b < count; b += 4 / channels)
+        {
+            Group& group(fGroups[fParallel ? groups++ : 0]);
+            group.count = std::min(4 / channels, count - b);
+            std::copy(running + b, running + b + group.count, group.bands);
+            group.channels = channels;
+            group.frames = frames;
+            group.rampSteps = rampSteps;
+            group.beatsPerFrame = beatsPerFrame;
+
+            if (! fParallel)
+            {
+                processGroup(group);
+                bookGroup(group, fProfiler.lap() / group.count);
+                sumGroup(group);
+            }
+        }
+
+        if (fParallel)
+        {
+            fWorkers.run(runGroup, this, groups);
+
+            // the kernels ran at the same time, each band is booked an equal share
+            const uint32_t ns = count > 0 ? fProfiler.lap() / count : 0;
+            for (uint32_t g = 0; g < groups; ++g)
+                bookGroup(fGroups[g], ns);
+            for (uint32_t g = 0; g < groups; ++g)
+                sumGroup(fGroups[g]);
+        }
+
+        fWritePos = (fWritePos + frames * oversamplingFactor(fActiveOversampling)) & fRingMask;
+
+        if (fActiveOversampling != kOversampling1x)
+            advanceOversampler(frames);
+
+        for (uint32_t i = 0; i < rampSteps; ++i)
+            stepCrossover();
+
+        if (fTelemetry.advance(frames))
+            publishTelemetry();
+        fProfiler.mark(kProfileParameters);
+
+        // inputs are fully consumed by now, so hosts that process in place are fine
+        std::memcpy(outL, fSumL, sizeof(float) * frames);
+        std::memcpy(outR, fMono ? fSumL : fSumR, sizeof(float) * frames);
+        fProfiler.mark(kProfileSum);
+    }
+
+   /**
+      Hand the meters each band's LFO phase and delay at the end of this chunk.
+      The delay is the kernel's, ignoring the extra sample the four tap interpolators read back at 1x.
+    */
+    void publishTelemetry()
+    {
+        float phases[kBandCount], delays[kBandCount];
+
+        for (uint32_t b = 0; b < kBandCount; ++b)
+        {
+            const Band& band(fBands[b]);
+            double phase = band.phase;
+
+            if (fSync == kSyncHost)
+            {
+                phase = fClockBeats * band.syncRatio + band.phaseOffset;
+                phase -= std::floor(phase);
+            }
+
+            const double lfo = 0.5 + 0.5 * std::sin(2.0 * M_PI * phase);
+            phases[b] = static_cast<float>(phase);
+            delays[b] = static_cast<float>((1.0 + band.intensity * fMaxDelay * lfo) * 1000.0 / fSampleRate);
+        }
+
+        fTelemetry.publish(phases, delays);
+    }
+
+    uint32_t ringSize(uint32_t factor) const
+    {
+        uint32_t size = 1;
+        while (size < fLineSize * factor)
+            size *= 2;
+        return size;
+    }
+
+   /**
+      Zero up to kClearChunkFloats of delay line per chunk of `frames`. First the spare set for a new oversampling
+      factor, the lines move over to it once it holds all of them and keep running at the old factor meanwhile.
+      Then the lines of stopped bands, which wake once theirs are clean. A switch of factor or crossover so never
+      clears all lines within one block.
+    */
+    void clearLines(uint32_t frames)
+    {
+        uint32_t budget = kClearChunkFloats * ((frames + kChunkSize - 1) / kChunkSize);
+
+        if (fActiveOversampling != fOversampling)
+            budget = switchOversampling(budget);
+
+        for (Band& band : fBands)
+        {
+            const uint32_t n = std::min(band.dirty, budget);
+            band.dirty -= n;
+            std::fill(band.lines[0] + band.dirty, band.lines[0] + band.dirty + n, 0.0f);
+            budget -= n;
+        }
+    }
+
+    // the part of `budget` left over, none until the lines have moved
+    uint32_t switchOversampling(uint32_t budget)
+    {
+        const uint32_t size = setFloats(fOversampling);
+        float* const spare = lineSet(fLineSet ^ 1);
+
+        if (fSpareCleared < size)
+        {
+            const uint32_t n = std::min(size - fSpareCleared, budget);
+            std::fill(spare + fSpareCleared, spare + fSpareCleared + n, 0.0f);
+            fSpareCleared += n;
+            budget -= n;
+            if (fSpareCleared < size)
+                return 0;
+        }
+
+        // the set left behind holds the old delays
+        fLineSet ^= 1;
+        fSpareCleared = 0;
+        fActiveOversampling = fOversampling;
+        layoutLines();
+
+        // the whole set is clean, stopped bands included
+        for (Band& band : fBands)
+        {
+            std::memset(band.allpass, 0, sizeof(band.allpass));
+            std::memset(band.history, 0, sizeof(band.history));
+            band.dirty = 0;
+        }
+        std::memset(fOversamplerPos, 0, sizeof(fOversamplerPos));
+        return budget;
+    }
+
+    // floats of one set of lines at an oversampling setting, a whole number of cache lines
+    uint32_t setFloats(int oversampling) const
+    {
+        return kBandCount * 2 * lineLength(ringSize(oversamplingFactor(oversampling)));
+    }
+
+    // first float of a set of lines, on a cache line
+    float* lineSet(uint32_t set)
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(fArena.data());
+        const uintptr_t align = kArenaAlign * sizeof(float);
+        return reinterpret_cast<float*>((address + align - 1) & ~(align - 1)) + set * setFloats(kOversampling4x);
+    }
+
+   /**
+      Place the band lines back to back in the active set at the ring size of the active factor, each starting on
+      a cache line. They hold whatever that part of the set held.
+    */
+    void layoutLines()
+    {
+        fRingSize = ringSize(oversamplingFactor(fActiveOversampling));
+        fRingMask = fRingSize - 1;
+        fWritePos = 0;
+
+        const uint32_t length = lineLength(fRingSize);
+        float* line = lineSet(fLineSet);
+
+        for (Band& band : fBands)
+        {
+            band.lineLength = length;
+            for (float*& l : band.lines)
+            {
+                l = line;
+                line += length;
+            }
+        }
+    }
+
+    // a ring plus its guard, rounded up to whole cache lines
+    static uint32_t lineLength(uint32_t ring)
+    {
+        return (ring + kLineGuard + kArenaAlign - 1) & ~(kArenaAlign - 1);
+    }
+
+   /**
+      Move the oversampler rings on by a chunk, every group starts its kernel from the same positions.
+    */
+    void advanceOversampler(uint32_t frames)
+    {
+        const bool quad = fActiveOversampling == kOversampling4x;
+        const uint32_t pushes[kOversamplerRingCount] = { 1, quad ? 2u : 0u, quad ? 4u : 0u, 2 };
+
+        for (uint32_t r = 0; r < kOversamplerRingCount; ++r)
+        {
+            const uint32_t size = kFl3ngrOversamplerRingSizes[r];
+            fOversamplerPos[r] = (fOversamplerPos[r] + size - pushes[r] * frames % size) % size;
+        }
+    }
+
+    static void runGroup(void* engine, uint32_t index)
+    {
+        Fl3ngrEngineT* const self = static_cast<Fl3ngrEngineT*>(engine);
+        self->processGroup(self->fGroups[index]);
+    }
+
+   /**
+      Run the kernel of a group and write its bands' state back. Touches nothing but the group and its bands.
+    */
+    void processGroup(Group& group)
+    {
+        Band* const* const bands = group.bands;
+        const uint32_t count = group.count;
+        const uint32_t channels = group.channels;
+        const uint32_t frames = group.frames;
+        const double beatsPerFrame = group.beatsPerFrame;
+        Lanes& s(group.lanes);
+        const uint32_t lanes = count * channels;
+
+        std::memset(&s, 0, sizeof(s));
+        s.out = group.out;
+        s.history = group.history;
+
+        for (uint32_t l = 0; l < lanes; ++l)
+        {
+            Band& band(*bands[l / channels]);
+            const uint32_t c = l % channels;
+
+            for (int n = 0; n < 2; ++n)
+            {
+                s.coeffs[n][0][l] = band.sections[n].b0;
+                s.coeffs[n][1][l] = band.sections[n].b1;
+                s.coeffs[n][2][l] = band.sections[n].b2;
+                s.coeffs[n][3][l] = band.sections[n].a1;
+                s.coeffs[n][4][l] = band.sections[n].a2;
+                s.coeffSteps[n][0][l] = band.sectionSteps[n].b0;
+                s.coeffSteps[n][1][l] = band.sectionSteps[n].b1;
+                s.coeffSteps[n][2][l] = band.sectionSteps[n].b2;
+                s.coeffSteps[n][3][l] = band.sectionSteps[n].a1;
+                s.coeffSteps[n][4][l] = band.sectionSteps[n].a2;
+                s.state[n][0][l] = band.state[c][n][0];
+                s.state[n][1][l] = band.state[c][n][1];
+            }
+
+            s.phase[l]        = static_cast<float>(band.phase);
+            s.phaseInc[l]     = static_cast<float>(fSync == kSyncHost ? band.syncRatio * beatsPerFrame : band.phaseInc);
+            s.depth[l]        = band.intensity * fMaxDelay;
+            s.depthStep[l]    = (band.targetIntensity - band.intensity) * fMaxDelay / frames;
+            s.feedback[l]     = band.feedback;
+            s.feedbackStep[l] = (band.targetFeedback - band.feedback) / frames;
+            s.mix[l]          = band.mix;
+            s.mixStep[l]      = (band.targetMix - band.mix) / frames;
+            s.gain[l]         = band.gain;
+            s.gainStep[l]     = (band.targetGain - band.gain) / frames;
+            s.fade[l]     = band.fade;
+            s.fadeStep[l] = band.enabled ? fFadeStep : -fFadeStep;
+            s.lines[l]    = band.lines[c];
+
+            for (uint32_t v = 0; v < band.voices; ++v)
+            {
+                s.allpass[v][l]     = band.allpass[v][c];
+                s.voicePhase[v][l]  = static_cast<float>(v) / band.voices;
+                s.voiceWeight[v][l] = 1.0f / band.voices;
+            }
+        }
+
+        s.coeffRampSteps = group.rampSteps;
+        s.voices = 1;
+        for (uint32_t b = 0; b < count; ++b)
+            s.voices = std::max(s.voices, bands[b]->voices);
+
+        int mode = fShortCircuit ? bands[0]->mixMode() : kMixBlend;
+        for (uint32_t b = 1; b < count; ++b)
+            if (bands[b]->mixMode() != mode)
+                mode = kMixBlend;
+
+        const bool oversampled = fActiveOversampling != kOversampling1x;
+
+        if (oversampled)
+        {
+            for (uint32_t i = 0; i < kFl3ngrOversamplerHistorySize; ++i)
+                for (uint32_t l = 0; l < 4; ++l)
+                    group.history[i][l] = l < lanes ? bands[l / channels]->history[i][l % channels] : 0.0f;
+        }
+
+        if (fActiveCrossover == kCrossoverLR4)
+        {
+            // lanes take their band's split output instead of filtering the input themselves, spare lanes repeat
+            // the last band
+            const float* split[4];
+            for (uint32_t l = 0; l < 4; ++l)
+                split[l] = fSplit[bands[std::min(l / channels, count - 1)] - fBands] + l % channels;
+
+            for (uint32_t i = 0; i < frames; ++i)
+            {
+                group.in[4 * i + 0] = split[0][4 * i];
+                group.in[4 * i + 1] = split[1][4 * i];
+                group.in[4 * i + 2] = split[2][4 * i];
+                group.in[4 * i + 3] = split[3][4 * i];
+            }
+
+            switch (mode)
+            {
+            case kMixDry: processLanes<kMixDry, false>(s, group.in, lanes, frames); break;
+            case kMixWet: processLanes<kMixWet, false>(s, group.in, lanes, frames); break;
+            default:      processLanes<kMixBlend, false>(s, group.in, lanes, frames); break;
+            }
+        }
+        else
+        {
+            switch (mode)
+            {
+            case kMixDry: processLanes<kMixDry, true>(s, fLaneIn, lanes, frames); break;
+            case kMixWet: processLanes<kMixWet, true>(s, fLaneIn, lanes, frames); break;
+            default:      processLanes<kMixBlend, true>(s, fLaneIn, lanes, frames); break;
+            }
+        }
+
+        // meters: peak and sum of squares of every lane's output
+        {
+            V peak = V::set1(0.0f), squares = V::set1(0.0f);
+            for (uint32_t i = 0; i < frames; ++i)
+            {
+                const V x = V::load(group.out + 4 * i);
+                peak = max(peak, abs(x));
+                squares = squares + x * x;
+            }
+
+            peak.store(group.peak);
+            squares.store(group.squares);
+        }
+
+        for (uint32_t l = 0; l < lanes; ++l)
+        {
+            Band& band(*bands[l / channels]);
+            const uint32_t c = l % channels;
+
+            for (int n = 0; n < 2; ++n)
+            {
+                band.state[c][n][0] = s.state[n][0][l];
+                band.state[c][n][1] = s.state[n][1][l];
+            }
+            for (uint32_t v = 0; v < kFl3ngrMaxVoices; ++v)
+                band.allpass[v][c] = s.allpass[v][l];
+
+            if (oversampled)
+            {
+                // a dry band only runs the input ring, it rejoins the filters from silence
+                const uint32_t kept = mode == kMixDry ? kFl3ngrOversamplerRingOffsets[kOversamplerRingUp]
+                                                      : kFl3ngrOversamplerHistorySize;
+                for (uint32_t i = 0; i < kept; ++i)
+                    band.history[i][c] = group.history[i][l];
+                for (uint32_t i = kept; i < kFl3ngrOversamplerHistorySize; ++i)
+                    band.history[i][c] = 0.0f;
+            }
+
+            if (c != 0)
+                continue;
+
+            // the lanes run the LFO in float within a chunk, the band advances it in double so it does not drift
+            band.phase = std::fmod(band.phase + band.phaseInc * frames, 1.0);
+            band.gain = band.targetGain;
+            band.mix = band.targetMix;
+            band.feedback = band.targetFeedback;
+            band.intensity = band.targetIntensity;
+            band.fade = s.fade[l];
+
+            if (! band.enabled && band.fade == 0.0f)
+                band.stop();
+        }
+    }
+
+    // the bands of a group share one kernel, each is booked its share
+    void bookGroup(const Group& group, uint32_t ns)
+    {
+        for (uint32_t b = 0; b < group.count; ++b)
+            fProfiler.add(kProfileBand + static_cast<uint32_t>(group.bands[b] - fBands), ns);
+    }
+
+    void sumGroup(const Group& group)
+    {
+        const uint32_t channels = group.channels;
+
+        // a mono lane stands for both outputs
+        for (uint32_t b = 0; b < group.count; ++b)
+            fTelemetry.addLevel(static_cast<uint32_t>(group.bands[b] - fBands),
+                                channels == 2 ? std::max(group.peak[2 * b], group.peak[2 * b + 1]) : group.peak[b],
+                                channels == 2 ? group.squares[2 * b] + group.squares[2 * b + 1]
+                                              : 2.0f * group.squares[b]);
+
+        for (uint32_t l = 0; l < group.count * channels; ++l)
+        {
+            float* const sum = l % channels ? fSumR : fSumL;
+            for (uint32_t i = 0; i < group.frames; ++i)
+                sum[i] += group.out[4 * i + l];
+        }
+
+        fProfiler.mark(kProfileSum);
+    }
+
+    template <int mode, bool bandFilters>
+    void processLanes(Lanes& s, const float* laneIn, uint32_t lanes, uint32_t frames)
+    {
+        switch (fActiveOversampling)
+        {
+        case kOversampling2x: processLanes<mode, bandFilters, 2>(s, laneIn, lanes, frames); break;
+        case kOversampling4x: processLanes<mode, bandFilters, 4>(s, laneIn, lanes, frames); break;
+        default:              processLanes<mode, bandFilters, 1>(s, laneIn, lanes, frames); break;
+        }
+    }
+
+    // one sample into every lane's delay line, the first kLineGuard slots are mirrored past the ring
+    void writeLines(Lanes& s, uint32_t lanes, const V& x, uint32_t& writePos)
+    {
+        float tmp[4];
+        x.store(tmp);
+
+        for (uint32_t l = 0; l < lanes; ++l)
+        {
+            s.lines[l][writePos] = tmp[l];
+            if (writePos < kLineGuard)
+                s.lines[l][writePos + fRingSize] = tmp[l];
+        }
+
+        writePos = (writePos + 1) & fRingMask;
+    }
+
+   /**
+      Every lane's delay line read `delay` samples behind the write position, by one voice with its allpass state.
+      The taps around the read position are gathered per lane, the interpolation runs on whole vectors.
+    */
+    V readLines(Lanes& s, uint32_t lanes, const V& delay, uint32_t writePos, float* allpass)
+    {
+        // the allpass reads half a sample further back, which keeps its own delay between 0.5 and 1.5
+        const float offset = fActiveInterpolation == kInterpolationAllpass ? 0.5f : 0.0f;
+        float tmp[4], p0[4] = {}, p1[4] = {}, p2[4] = {}, p3[4] = {}, frac[4] = {};
+        (delay + V::set1(offset)).store(tmp);
+
+        // linear interpolation only needs the middle two
+        const bool outerTaps = fActiveInterpolation != kInterpolationLinear;
+
+        for (uint32_t l = 0; l < lanes; ++l)
+        {
+            // split the delay rather than the read position, so the fraction keeps full precision
+            const uint32_t whole = static_cast<uint32_t>(tmp[l]);
+            const uint32_t i = writePos - whole - 1;
+            const float* const tap = s.lines[l] + ((i - 1) & fRingMask);
+
+            frac[l] = 1.0f - (tmp[l] - static_cast<float>(whole));
+            p1[l] = tap[1];
+            p2[l] = tap[2];
+
+            if (outerTaps)
+            {
+                p0[l] = tap[0];
+                p3[l] = tap[3];
+            }
+        }
+
+        const V t = V::load(frac);
+        const V y1 = V::load(p1), y2 = V::load(p2);
+
+        if (! outerTaps)
+            return y1 + t * (y2 - y1);
+
+        const V y0 = V::load(p0), y3 = V::load(p3);
+
+        switch (fActiveInterpolation)
+        {
+        case kInterpolationCubic:
+        {
+            // Catmull-Rom
+            const V half = V::set1(0.5f);
+            const V c1 = half * (y2 - y0);
+            const V c2 = y0 - V::set1(2.5f) * y1 + V::set1(2.0f) * y2 - half * y3;
+            const V c3 = half * (y3 - y0) + V::set1(1.5f) * (y1 - y2);
+            return ((c3 * t + c2) * t + c1) * t + y1;
+        }
+        case kInterpolationLagrange:
+        {
+            // 3rd order through the taps at -1, 0, 1 and 2
+            const V one = V::set1(1.0f);
+            const V tp = t + one, tm = t - one, tm2 = t - V::set1(2.0f);
+            const V a = tm * tm2, b = tp * t;
+            return V::set1(1.0f / 6.0f) * (b * tm * y3 - a * t * y0)
+                 + V::set1(0.5f) * (a * tp * y1 - b * tm2 * y2);
+        }
+        default:
+        {
+            // allpass, first order over taps 2 and 3, delaying the newer one by 1.5 - t
+            float eta[4];
+            for (uint32_t l = 0; l < 4; ++l)
+                eta[l] = (frac[l] - 0.5f) / (2.5f - frac[l]);
+
+            const V y = fl3ngrFlushDenormals(y2 + V::load(eta) * (y3 - V::load(allpass)));
+            y.store(allpass);
+            return y;
+        }
+        }
+    }
+
+    // push one sample onto an oversampler ring, returns where its newest first history starts
+    static float* pushHistory(Lanes& s, uint32_t* pos, uint32_t ring, const V& x)
+    {
+        const uint32_t size = kFl3ngrOversamplerRingSizes[ring];
+        pos[ring] = (pos[ring] == 0 ? size : pos[ring]) - 1;
+
+        float* const newest = s.history[kFl3ngrOversamplerRingOffsets[ring] + pos[ring]];
+        x.store(newest);
+        x.store(newest + 4 * size);
+        return newest;
+    }
+
+    template <int mode, bool bandFilters, uint32_t factor>
+    void processLanes(Lanes& s, const float* laneIn, uint32_t lanes, uint32_t frames)
+    {
+        V b00 = V::load(s.coeffs[0][0]), b01 = V::load(s.coeffs[0][1]), b02 = V::load(s.coeffs[0][2]);
+        V a01 = V::load(s.coeffs[0][3]), a02 = V::load(s.coeffs[0][4]);
+        V b10 = V::load(s.coeffs[1][0]), b11 = V::load(s.coeffs[1][1]), b12 = V::load(s.coeffs[1][2]);
+        V a11 = V::load(s.coeffs[1][3]), a12 = V::load(s.coeffs[1][4]);
+        V z01 = V::load(s.state[0][0]), z02 = V::load(s.state[0][1]);
+        V z11 = V::load(s.state[1][0]), z12 = V::load(s.state[1][1]);
+
+        V phase = V::load(s.phase);
+        V gain = V::load(s.gain);
+        V fade = V::load(s.fade);
+        V depth = V::load(s.depth);
+        V feedback = V::load(s.feedback);
+        V mix = V::load(s.mix);
+        const V phaseInc = V::load(s.phaseInc);
+        const V depthStep = V::load(s.depthStep);
+        const V feedbackStep = V::load(s.feedbackStep);
+        const V mixStep = V::load(s.mixStep);
+        const V gainStep = V::load(s.gainStep);
+        const V fadeStep = V::load(s.fadeStep);
+
+        const V zero = V::set1(0.0f);
+        const V half = V::set1(0.5f);
+        const V one = V::set1(1.0f);
+        const V two = V::set1(2.0f);
+        const V rate = V::set1(static_cast<float>(factor));
+
+        const uint32_t latency = oversamplingLatency(fActiveOversampling);
+        uint32_t writePos = fWritePos;
+
+        // the four tap interpolators need the sample after the one they read at
+        const V minDelay = V::set1(factor == 1 && fActiveInterpolation != kInterpolationLinear ? 2.0f : 1.0f);
+
+        uint32_t pos[kOversamplerRingCount];
+        std::memcpy(pos, fOversamplerPos, sizeof(pos));
+
+        // the LFO is evaluated at sub-block edges and interpolated in between, fast math builds turn a quadrature
+        // pair from edge to edge instead, every full sub-block moves the phase on by the same step
+        Fl3ngrQuadrature<V> quadrature;
+        if (kQuadratureLfo)
+            quadrature.start(phase, phaseInc * V::set1(static_cast<float>(kRampSize)));
+
+        V lfoStart = half + half * (kQuadratureLfo ? quadrature.sin : fl3ngrLfoSin2Pi(phase));
+        V lfo = lfoStart, lfoStep = zero;
+
+        // the voices after the first sweep the same way from their own phase offsets
+        const uint32_t voices = mode != kMixDry ? s.voices : 1;
+        V voicePhase[kFl3ngrMaxVoices], voiceWeight[kFl3ngrMaxVoices];
+        V voiceSin[kFl3ngrMaxVoices], voiceCos[kFl3ngrMaxVoices];
+        V voiceLfoStart[kFl3ngrMaxVoices], voiceLfo[kFl3ngrMaxVoices], voiceLfoStep[kFl3ngrMaxVoices];
+
+        for (uint32_t v = 0; v < voices; ++v)
+        {
+            voicePhase[v] = V::load(s.voicePhase[v]);
+            voiceWeight[v] = V::load(s.voiceWeight[v]);
+
+            if (kQuadratureLfo)
+            {
+                voiceSin[v] = fl3ngrSin2Pi(voicePhase[v]);
+                voiceCos[v] = fl3ngrSin2Pi(wrapUnit(voicePhase[v] + V::set1(0.25f)));
+                voiceLfoStart[v] = half + half * quadrature.shifted(voiceSin[v], voiceCos[v]);
+            }
+            else
+                voiceLfoStart[v] = half + half * fl3ngrLfoSin2Pi(wrapUnit(phase + voicePhase[v]));
+        }
+
+        for (uint32_t start = 0, step = 0; start < frames; start += kRampSize, ++step)
+        {
+            if (bandFilters && step < s.coeffRampSteps)
+            {
+                b00 = b00 + V::load(s.coeffSteps[0][0]);
+                b01 = b01 + V::load(s.coeffSteps[0][1]);
+                b02 = b02 + V::load(s.coeffSteps[0][2]);
+                a01 = a01 + V::load(s.coeffSteps[0][3]);
+                a02 = a02 + V::load(s.coeffSteps[0][4]);
+                b10 = b10 + V::load(s.coeffSteps[1][0]);
+                b11 = b11 + V::load(s.coeffSteps[1][1]);
+                b12 = b12 + V::load(s.coeffSteps[1][2]);
+                a11 = a11 + V::load(s.coeffSteps[1][3]);
+                a12 = a12 + V::load(s.coeffSteps[1][4]);
+            }
+
+            if (bandFilters)
+            {
+                z01 = fl3ngrFlushDenormals(z01);
+                z02 = fl3ngrFlushDenormals(z02);
+                z11 = fl3ngrFlushDenormals(z11);
+                z12 = fl3ngrFlushDenormals(z12);
+            }
+
+            const uint32_t end = std::min(start + kRampSize, frames);
+
+            if (mode != kMixDry)
+            {
+                const float len = static_cast<float>(end - start);
+                phase = wrapUnit(phase + phaseInc * V::set1(len));
+
+                // only a chunk's last sub-block can be shorter
+                const bool rotate = kQuadratureLfo && end - start == kRampSize;
+                if (rotate)
+                    quadrature.advance();
+
+                const V lfoEnd = half + half * (rotate ? quadrature.sin : fl3ngrLfoSin2Pi(phase));
+                lfo = lfoStart;
+                lfoStep = (lfoEnd - lfoStart) * V::set1(1.0f / len);
+                lfoStart = lfoEnd;
+
+                for (uint32_t v = 1; v < voices; ++v)
+                {
+                    const V voiceEnd = half + half * (rotate ? quadrature.shifted(voiceSin[v], voiceCos[v])
+                                                             : fl3ngrLfoSin2Pi(wrapUnit(phase + voicePhase[v])));
+                    voiceLfo[v] = voiceLfoStart[v];
+                    voiceLfoStep[v] = (voiceEnd - voiceLfoStart[v]) * V::set1(1.0f / len);
+                    voiceLfoStart[v] = voiceEnd;
+                }
+            }
+
+            for (uint32_t i = start; i < end; ++i)
+            {
+                V x = V::load(laneIn + 4 * i);
+
+                if (bandFilters)
+                {
+                    // EQ crossover, the difference of two sections per band
+                    const V y0 = b00 * x + z01;
+                    z01 = b01 * x - a01 * y0 + z02;
+                    z02 = b02 * x - a02 * y0;
+                    const V y1 = b10 * x + z11;
+                    z11 = b11 * x - a11 * y1 + z12;
+                    z12 = b12 * x - a12 * y1;
+                    x = y0 - y1;
+                }
+
+                gain = gain + gainStep;
+                x = x * gain;
+                fade = min(max(fade + fadeStep, zero), one);
+
+                V out;
+
+                if (factor == 1)
+                {
+                    if (mode == kMixDry)
+                    {
+                        writeLines(s, lanes, x, writePos);
+                        out = x;
+                    }
+                    else
+                    {
+                        depth = depth + depthStep;
+                        feedback = feedback + feedbackStep;
+
+                        V wet = readLines(s, lanes, minDelay + depth * lfo, writePos, s.allpass[0]);
+                        lfo = lfo + lfoStep;
+
+                        if (voices > 1)
+                        {
+                            wet = wet * voiceWeight[0];
+                            for (uint32_t v = 1; v < voices; ++v)
+                            {
+                                const V delay = minDelay + depth * voiceLfo[v];
+                                wet = wet + voiceWeight[v] * readLines(s, lanes, delay, writePos, s.allpass[v]);
+                                voiceLfo[v] = voiceLfo[v] + voiceLfoStep[v];
+                            }
+                        }
+
+                        writeLines(s, lanes, fl3ngrFlushDenormals(x + feedback * wet), writePos);
+
+                        if (mode == kMixWet)
+                        {
+                            out = wet;
+                        }
+                        else
+                        {
+                            mix = mix + mixStep;
+                            out = (one - mix) * x + mix * wet;
+                        }
+                    }
+                }
+                else
+                {
+                    const float* const input = pushHistory(s, pos, kOversamplerRingBase, x);
+                    const V dry = V::load(input + 4 * latency);
+
+                    if (mode == kMixDry)
+                    {
+                        // holding the input keeps the lines warm for when the mix comes up
+                        for (uint32_t k = 0; k < factor; ++k)
+                            writeLines(s, lanes, x, writePos);
+                        out = dry;
+                    }
+                    else
+                    {
+                        depth = depth + depthStep;
+                        feedback = feedback + feedbackStep;
+
+                        // interpolate: one output is filtered, the other one is an input sample
+                        V up[4];
+                        up[0] = two * fl3ngrHalfband<V, kFl3ngrHalfband2xTaps, 1>(input, kFl3ngrHalfband2x);
+                        up[1] = V::load(input + 4 * (kFl3ngrHalfband2xTaps - 1));
+
+                        if (factor == 4)
+                        {
+                            const V twice[2] = { up[0], up[1] };
+                            for (uint32_t k = 0; k < 2; ++k)
+                            {
+                                const float* const mid = pushHistory(s, pos, kOversamplerRingUp, twice[k]);
+                                up[2 * k] = two * fl3ngrHalfband<V, kFl3ngrHalfband4xTaps, 1>(mid, kFl3ngrHalfband4x);
+                                up[2 * k + 1] = V::load(mid + 4 * (kFl3ngrHalfband4xTaps - 1));
+                            }
+                        }
+
+                        // the delay sweeps at the oversampled rate, in oversampled samples
+                        V delay = rate * (one + depth * lfo);
+                        const V delayStep = depth * lfoStep;
+                        lfo = lfo + lfoStep;
+
+                        V voiceDelay[kFl3ngrMaxVoices], voiceDelayStep[kFl3ngrMaxVoices];
+                        for (uint32_t v = 1; v < voices; ++v)
+                        {
+                            voiceDelay[v] = rate * (one + depth * voiceLfo[v]);
+                            voiceDelayStep[v] = depth * voiceLfoStep[v];
+                            voiceLfo[v] = voiceLfo[v] + voiceLfoStep[v];
+                        }
+
+                        const float* down = nullptr;
+
+                        for (uint32_t k = 0; k < factor; ++k)
+                        {
+                            V wet = readLines(s, lanes, delay, writePos, s.allpass[0]);
+                            delay = delay + delayStep;
+
+                            if (voices > 1)
+                            {
+                                wet = wet * voiceWeight[0];
+                                for (uint32_t v = 1; v < voices; ++v)
+                                {
+                                    const V read = readLines(s, lanes, voiceDelay[v], writePos, s.allpass[v]);
+                                    wet = wet + voiceWeight[v] * read;
+                                    voiceDelay[v] = voiceDelay[v] + voiceDelayStep[v];
+                                }
+                            }
+
+                            writeLines(s, lanes, fl3ngrFlushDenormals(up[k] + feedback * wet), writePos);
+
+                            if (factor == 2)
+                            {
+                                down = pushHistory(s, pos, kOversamplerRingDown, wet);
+                            }
+                            else
+                            {
+                                const float* const high = pushHistory(s, pos, kOversamplerRingDownHigh, wet);
+                                if (k % 2 != 0)
+                                {
+                                    const V y = fl3ngrHalfband<V, kFl3ngrHalfband4xTaps, 2>(high + 4, kFl3ngrHalfband4x)
+                                              + half * V::load(high + 4 * (1 + 2 * kFl3ngrHalfband4xTaps - 1));
+                                    down = pushHistory(s, pos, kOversamplerRingDown, y);
+                                }
+                            }
+                        }
+
+                        // decimate, 2x keeps the phase one sample back
+                        if (factor == 2)
+                            down += 4;
+
+                        const V wet = fl3ngrHalfband<V, kFl3ngrHalfband2xTaps, 2>(down, kFl3ngrHalfband2x)
+                                    + half * V::load(down + 4 * (2 * kFl3ngrHalfband2xTaps - 1));
+
+                        if (mode == kMixWet)
+                        {
+                            out = wet;
+                        }
+                        else
+                        {
+                            mix = mix + mixStep;
+                            out = (one - mix) * dry + mix * wet;
+                        }
+                    }
+                }
+
+                (out * fade).store(s.out + 4 * i);
+            }
+        }
+
+        z01.store(s.state[0][0]);
+        z02.store(s.state[0][1]);
+        z11.store(s.state[1][0]);
+        z12.store(s.state[1][1]);
+        fade.store(s.fade);
+    }
+
+    static constexpr uint32_t kSplitCount = kFl3ngrSplitCount;
+    static constexpr uint32_t kSplitFilterCount = 2 * kSplitCount + (kBandCount - 1) * (kBandCount - 2) / 2;
+
+    double fSampleRate = 0.0;
+    int fCrossover = kCrossoverEq;
+    int fActiveCrossover = kCrossoverEq;
+    int fSync = kSyncFree;
+    bool fTransportPlaying = false;
+    double fTransportBeats = 0.0;
+    double fTempo = 120.0;
+    double fClockBeats = 0.0;
+    bool fCrossoverDirty = false;
+    uint32_t fCrossoverRampSteps = 1;
+    uint32_t fCrossoverStepsLeft = 0;
+    Fl3ngrSvfCoeffs fSplits[kSplitCount];
+    double fSplitG[kSplitCount] = {};
+    double fSplitTargetG[kSplitCount] = {};
+    double fSplitGStep[kSplitCount] = {};
+    float fSplitState[kSplitFilterCount][2][4] = {};
+    float fFadeStep = 1.0f;
+    float fMaxDelay = 0.0f;
+    uint32_t fLineSize = 0;
+    uint32_t fRingSize = 1;
+    uint32_t fRingMask = 0;
+    uint32_t fWritePos = 0;
+    std::vector<float> fArena;
+    uint32_t fLineSet = 0;      // set of the arena the lines are in
+    uint32_t fSpareCleared = 0; // floats at the start of the other set zeroed since it was last used
+    Fl3ngrPatchProcessor* fPatch = nullptr;
+    std::atomic<float> fParameters[kFl3ngrParameterCount];
+    uint8_t fParameterBands[kFl3ngrParameterCount];     // kBandCount for the shared ones
+    uint8_t fParameterControls[kFl3ngrParameterCount];
+    std::atomic<uint64_t> fDirty { 0 };  // one bit per parameter set since the last block
+    std::atomic<bool> fResync { false };
+    std::atomic<uint32_t> fRestoreVersion { 0 };
+    Band fBands[kBandCount];
+    Group fGroups[kGroupCount];  // only the first one unless the chunk runs in parallel
+    Fl3ngrWorkers fWorkers;
+    bool fParallel = false;
+    bool fShortCircuit = true;
+    int fRender = kRenderRealtime;
+    int fOversampling = kOversampling1x;
+    int fActiveOversampling = kOversampling1x;
+    int fInterpolation = kInterpolationLinear;
+    int fActiveInterpolation = kInterpolationLinear;
+    uint32_t fOversamplerPos[kOversamplerRingCount] = {};
+    Fl3ngrProfiler fProfiler;
+    Fl3ngrTelemetry fTelemetry;
+    uint32_t fSilentFrames = 0;
+    uint32_t fSilentTail = 0;
+    bool fSleeping = false;
+    uint32_t fMonoFrames = 0;
+    bool fMono = false;
+
+    float fLaneIn[kChunkSize * 4];
+    float fSplit[kBandCount][kChunkSize * 4];
+    float fSumL[kChunkSize];
+    float fSumR[kChunkSize];
+};
+
+typedef Fl3ngrEngineT<Fl3ngrVec4> Fl3ngrEngine;
+typedef Fl3ngrEngineT<Fl3ngrScalar4> Fl3ngrScalarEngine;
+
+// --------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "Fl3ngrSimd.hpp"
+
+// `make FAST_MATH=true` swaps libm and the precise LFO polynomial for the kernels below
+#ifndef FL3NGR_FAST_MATH
+# define FL3NGR_FAST_MATH 0
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Fast math
+//
+// The engine's transcendental work is the LFO sine at every sub-block edge, the dB to gain conversion of the band
+// gains, the crossover points spread geometrically around Freq and the editor's meters in dB. Fast math builds
+// (FL3NGR_FAST_MATH=1) run these on minimax polynomials instead, and the LFO on a quadrature oscillator that turns
+// its sine and cosine by a fixed step from edge to edge, so only each chunk's first edge evaluates polynomials.
+// Other builds use libm and fl3ngrSin2Pi(), and render exactly as before.
+//
+// Error bounds, checked by `fl3ngr-bench -A` against libm in double precision:
+//  - fl3ngrFastSin2Pi():   1e-5 absolute (fl3ngrSin2Pi(): 6e-7 with float rounding)
+//  - Fl3ngrQuadrature:     1e-6 absolute, after the most edges a chunk has
+//  - fl3ngrFastExp2():     4e-6 relative, so fl3ngrDbToGain() is within 4e-5 dB
+//  - fl3ngrFastLog2():     4e-6 absolute, so fl3ngrGainToDb() is within 3e-5 dB
+
+/**
+   sin(2 pi p) for a phase p in [0, 1), like fl3ngrSin2Pi() with two terms fewer.
+ */
+template <class V>
+static inline V fl3ngrFastSin2Pi(V p)
+{
+    const V x = p - V::set1(0.5f);
+    const V u = abs(x) - V::set1(0.25f);
+    const V t = u * u;
+
+    V c = V::set1(-78.21613268812533f);
+    c = c * t + V::set1(64.66054333305297f);
+    c = c * t + V::set1(-19.73575219015386f);
+    c = c * t + V::set1(0.9999932967876237f);
+
+    return copysign(c, V::set1(0.0f) - x);
+}
+
+/**
+   2 to the power of x, for x between -126 and 126.
+ */
+static inline float fl3ngrFastExp2(float x)
+{
+    x = std::max(-126.0f, std::min(126.0f, x));
+
+    // truncating a positive number floors it
+    const int whole = static_cast<int>(x + 127.0f) - 127;
+    const float f = x - static_cast<float>(whole);
+    const float mantissa = (((0.01353417039471745f * f + 0.05201147263399658f) * f + 0.24144273603217212f) * f
+                            + 0.6930038430038963f) * f + 1.000002592586878f;
+
+    const uint32_t bits = static_cast<uint32_t>(whole + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return mantissa * scale;
+}
+
+/**
+   Base 2 logarithm of a positive, normal x.
+ */
+static inline float fl3ngrFastLog2(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const int exponent = static_cast<int>(bits >> 23) - 127;
+
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    const float t = m - 1.0f;
+    const float log = (((((-0.026457204536488248f * t + 0.123450828141571f) * t - 0.27953748495144387f) * t
+                         + 0.4582705149986167f) * t - 0.7182818631030791f) * t + 1.4425531415928194f) * t;
+    return static_cast<float>(exponent) + log;
+}
+
+/**
+   Sine and cosine of an LFO phase that moves on by the same step every call to advance().
+   The step's sine and cosine have to be far more precise than the fast polynomial, whose error would turn and
+   scale the pair a little further every advance, so they come from series that are exact to float rounding for
+   small steps, and the pair from fl3ngrSin2Pi(). Each advance is then four multiplies and two adds, and as rounding
+   still makes the pair drift slowly, it is started over from the phase every chunk.
+ */
+template <class V>
+struct Fl3ngrQuadrature
+{
+    V sin, cos;
+    V stepSin, stepCos;
+
+    // phase in cycles in [0, 1), step in cycles up to a quarter
+    void start(const V& phase, const V& step)
+    {
+        sin = fl3ngrSin2Pi(phase);
+        cos = fl3ngrSin2Pi(wrapUnit(phase + V::set1(0.25f)));
+
+        // Taylor series, which keep their precision relative down to the smallest steps
+        const V x = step * V::set1(6.283185307179586f);
+        const V t = x * x;
+
+        V s = V::set1(-1.0f / 39916800.0f);
+        s = s * t + V::set1(1.0f / 362880.0f);
+        s = s * t + V::set1(-1.0f / 5040.0f);
+        s = s * t + V::set1(1.0f / 120.0f);
+        s = s * t + V::set1(-1.0f / 6.0f);
+        stepSin = (s * t + V::set1(1.0f)) * x;
+
+        V c = V::set1(1.0f / 479001600.0f);
+        c = c * t + V::set1(-1.0f / 3628800.0f);
+        c = c * t + V::set1(1.0f / 40320.0f);
+        c = c * t + V::set1(-1.0f / 720.0f);
+        c = c * t + V::set1(1.0f / 24.0f);
+        c = c * t + V::set1(-0.5f);
+        stepCos = c * t + V::set1(1.0f);
+    }
+
+    void advance()
+    {
+        const V s = sin * stepCos + cos * stepSin;
+        cos = cos * stepCos - sin * stepSin;
+        sin = s;
+    }
+
+    // sine of the phase plus an offset, given the offset's sine and cosine
+    V shifted(const V& offsetSin, const V& offsetCos) const
+    {
+        return sin * offsetCos + cos * offsetSin;
+    }
+};
+
+/**
+   The LFO sine of this build.
+ */
+template <class V>
+static inline V fl3ngrLfoSin2Pi(V p)
+{
+#if FL3NGR_FAST_MATH
+    return fl3ngrFastSin2Pi(p);
+#else
+    return fl3ngrSin2Pi(p);
+#endif
+}
+
+static inline float fl3ngrDbToGain(float db)
+{
+#if FL3NGR_FAST_MATH
+    return fl3ngrFastExp2(db * 0.16609640474436813f);  // log2(10) / 20
+#else
+    return std::pow(10.0f, db / 20.0f);
+#endif
+}
+
+static inline float fl3ngrGainToDb(float gain)
+{
+#if FL3NGR_FAST_MATH
+    return 6.020599913279624f * fl3ngrFastLog2(gain);  // 20 / log2(10)
+#else
+    return 20.0f * std::log10(gain);
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------
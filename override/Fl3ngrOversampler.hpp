@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+
+// --------------------------------------------------------------------------------------------------------------------
+// Half-band polyphase FIRs for running the flangers at 2x or 4x the host rate.
+//
+// Both filters are Kaiser windowed sincs (beta 7, about 70 dB stopband). Every other tap of a half-band is zero and
+// the centre one is 0.5, so an interpolator computes one of its two outputs per input with half the taps and copies
+// the other one, a decimator filters only the samples it keeps. The filters are linear phase: the whole chain
+// delays by a whole number of host samples, which the dry path and the host latency are matched to.
+//
+// Only the unique nonzero taps before the centre are stored, the filters are symmetric around it.
+//  - 2x stage: 47 taps, passes 0.4 of the host rate (19.2 kHz at 48 kHz), aliases fold from above 0.6.
+//  - 4x stage: 19 taps between 2x and 4x, its images sit far above anything the 2x stage lets through.
+
+static const uint32_t kFl3ngrHalfband2xTaps = 12;
+static const uint32_t kFl3ngrHalfband4xTaps = 5;
+
+static const float kFl3ngrHalfband2x[kFl3ngrHalfband2xTaps] = {
+    -8.20876043e-05f, 0.000390509717f, -0.00107084858f, 0.00234739784f, -0.00451321006f, 0.00795273812f,
+    -0.0132047624f, 0.021137199f, -0.0334617067f, 0.0545325883f, -0.100391569f, 0.316363751f
+};
+
+static const float kFl3ngrHalfband4x[kFl3ngrHalfband4xTaps] = {
+    0.000209843574f, -0.004318747f, 0.0215620594f, -0.0733410843f, 0.305887928f
+};
+
+/**
+   Filter history of four lanes, interleaved.
+   Every ring is stored twice in a row and written newest first, so Size consecutive samples can be read
+   from the newest one backwards in time without wrapping. The engine keeps one position per ring.
+ */
+enum Fl3ngrOversamplerRings
+{
+    kOversamplerRingBase,      // host rate input, feeds the 2x interpolator and the dry path
+    kOversamplerRingUp,        // 2x interpolator output, feeds the 4x interpolator
+    kOversamplerRingDownHigh,  // 4x flanger output, feeds the 4x decimator
+    kOversamplerRingDown,      // 2x flanger or 4x decimator output, feeds the 2x decimator
+    kOversamplerRingCount
+};
+
+static const uint32_t kFl3ngrOversamplerRingSizes[kOversamplerRingCount] = { 32, 16, 20, 48 };
+static const uint32_t kFl3ngrOversamplerRingOffsets[kOversamplerRingCount] = { 0, 64, 96, 136 };
+static const uint32_t kFl3ngrOversamplerHistorySize = 232;
+
+/**
+   Sum of the nonzero side taps over a history read newest first, Stride samples apart.
+   Pairs of samples sharing a tap are added before the multiply.
+ */
+template <class V, uint32_t Taps, uint32_t Stride>
+static inline V fl3ngrHalfband(const float* newest, const float* taps)
+{
+    const uint32_t last = (2 * Taps - 1) * Stride;
+    V sum = V::set1(0.0f);
+
+    for (uint32_t j = 0; j < Taps; ++j)
+        sum = sum + V::set1(taps[j]) * (V::load(newest + 4 * j * Stride) + V::load(newest + 4 * (last - j * Stride)));
+
+    return sum;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
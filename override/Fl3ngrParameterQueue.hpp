@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Index of the lowest set bit of a non-zero mask, to walk the parameters flagged in one.
+ */
+static inline uint32_t fl3ngrLowestBit(uint64_t mask)
+{
+#if defined(__GNUC__)
+    return static_cast<uint32_t>(__builtin_ctzll(mask));
+#else
+    uint32_t index = 0;
+    for (; (mask & 1) == 0; mask >>= 1)
+        ++index;
+    return index;
+#endif
+}
+
+/**
+   Fixed size, wait-free single producer single consumer ring.
+   One thread pushes, one other thread pops, neither ever blocks or allocates.
+   Capacity must be a power of two, one slot is never used to tell a full ring from an empty one.
+ */
+template <class T, uint32_t Capacity>
+class Fl3ngrSpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    bool push(const T& item)
+    {
+        const uint32_t write = fWrite.load(std::memory_order_relaxed);
+        const uint32_t next = (write + 1) & (Capacity - 1);
+
+        if (next == fRead.load(std::memory_order_acquire))
+            return false;
+
+        fItems[write] = item;
+        fWrite.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        const uint32_t read = fRead.load(std::memory_order_relaxed);
+
+        if (read == fWrite.load(std::memory_order_acquire))
+            return false;
+
+        item = fItems[read];
+        fRead.store((read + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    // the items sit between the indices, so producer and consumer do not keep stealing one cache line
+    // (the engine is heap allocated and C++11 new ignores alignas)
+    std::atomic<uint32_t> fWrite { 0 };
+    T fItems[Capacity];
+    std::atomic<uint32_t> fRead { 0 };
+};
+
+// --------------------------------------------------------------------------------------------------------------------
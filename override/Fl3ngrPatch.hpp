@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "Fl3ngrEngine.hpp"
+#include "Heavy_WSTD_FL3NGR.h"
+
+#if FL3NGR_BAND_COUNT == 3
+
+// --------------------------------------------------------------------------------------------------------------------
+// The Classic crossover: WSTD_FL3NGR.pd as hvcc compiles it, what the plugin ran before the native engine.
+//
+// Owns the hvcc context and sends the values of the parameters the patch has receivers for to it, like the hvcc
+// generated wrapper did. Blocks go to hv_process() whole, as the host hands them over, so a render matches the
+// bench's `-e heavy` bit for bit.
+
+class Fl3ngrPatch : public Fl3ngrPatchProcessor
+{
+public:
+    Fl3ngrPatch()
+    {
+        for (uint32_t i = 0; i < kFl3ngrPatchParameterCount; ++i)
+        {
+            fHashes[i] = hv_stringToHash(kFl3ngrParameters[i].receiver);
+            fValues[i] = kFl3ngrParameters[i].def;
+        }
+    }
+
+    ~Fl3ngrPatch() override
+    {
+        if (fContext != nullptr)
+            hv_delete(fContext);
+    }
+
+   /**
+      Start a new context at a new rate, on the last values set. Not realtime safe.
+    */
+    void setSampleRate(double sampleRate)
+    {
+        if (fContext != nullptr)
+            hv_delete(fContext);
+
+        fContext = hv_WSTD_FL3NGR_new(sampleRate);
+
+        for (uint32_t i = 0; i < kFl3ngrPatchParameterCount; ++i)
+            hv_sendFloatToReceiver(fContext, fHashes[i], fValues[i]);
+    }
+
+    void setParameter(uint32_t index, float value) override
+    {
+        if (index >= kFl3ngrPatchParameterCount)
+            return;
+
+        fValues[index] = value;
+        if (fContext != nullptr)
+            hv_sendFloatToReceiver(fContext, fHashes[index], value);
+    }
+
+    void process(const float* inL, const float* inR, float* outL, float* outR, uint32_t frames) override
+    {
+        // hv_process() only reads the inputs
+        float* inputs[2] = { const_cast<float*>(inL), const_cast<float*>(inR) };
+        float* outputs[2] = { outL, outR };
+
+        hv_process(fContext, inputs, outputs, static_cast<int>(frames));
+    }
+
+private:
+    HeavyContextInterface* fContext = nullptr;
+    uint32_t fHashes[kFl3ngrPatchParameterCount];
+    float fValues[kFl3ngrPatchParameterCount];
+};
+
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
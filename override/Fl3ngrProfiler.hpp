@@ -0,0 +1,226 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "Fl3ngrBands.hpp"
+
+#ifndef FL3NGR_PROFILE
+# define FL3NGR_PROFILE 0
+#endif
+
+#if FL3NGR_PROFILE
+# include <algorithm>
+# include <chrono>
+# include "Fl3ngrParameterQueue.hpp"
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// DSP stage timing, compiled in with -DFL3NGR_PROFILE=1 (`make PROFILE=true`), otherwise every call is empty.
+//
+// The audio thread times each stage of a block and pushes one record per block into a lock-free ring,
+// a reader on any one other thread (or the audio thread itself) folds them into min/avg/max ns per sample.
+
+enum Fl3ngrProfileStages
+{
+    kProfileProcess,    // the whole process() call
+    kProfileParameters, // applying the changed parameters, retargeting and stepping the crossover
+    kProfileCrossover,  // lane input and the LR4 split, the EQ crossover runs inside the band kernels
+    kProfileBand,       // one stage per band, in band order
+    kProfileSum = kProfileBand + kFl3ngrBandCount,  // summing the bands into the outputs
+    kProfileStageCount
+};
+
+#define FL3NGR_PROFILE_BAND_NAME(receiver, name, symbol) #symbol,
+static const char* const kFl3ngrProfileStageNames[kProfileStageCount] = {
+    "process", "parameters", "crossover", FL3NGR_BANDS(FL3NGR_PROFILE_BAND_NAME) "sum"
+};
+#undef FL3NGR_PROFILE_BAND_NAME
+
+// hidden output parameters of a profiling build, min/avg/max per stage after the regular parameters
+enum Fl3ngrProfileValues
+{
+    kProfileMin,
+    kProfileAvg,
+    kProfileMax,
+    kProfileValueCount
+};
+
+static const uint32_t kFl3ngrProfileParameterCount = FL3NGR_PROFILE ? kProfileStageCount * kProfileValueCount : 0;
+
+#if FL3NGR_PROFILE
+
+struct Fl3ngrProfileRecord
+{
+    uint32_t frames;
+    uint32_t ns[kProfileStageCount];
+};
+
+class Fl3ngrProfiler
+{
+    typedef std::chrono::steady_clock clock;
+
+public:
+    static constexpr bool kEnabled = true;
+
+    void begin()
+    {
+        fStart = fLast = clock::now();
+        std::fill(fRecord.ns, fRecord.ns + kProfileStageCount, 0u);
+    }
+
+    // time since the previous mark, without booking it to a stage
+    uint32_t lap()
+    {
+        const clock::time_point now = clock::now();
+        const uint32_t ns = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - fLast).count());
+        fLast = now;
+        return ns;
+    }
+
+    void add(uint32_t stage, uint32_t ns)
+    {
+        fRecord.ns[stage] += ns;
+    }
+
+    void mark(uint32_t stage)
+    {
+        add(stage, lap());
+    }
+
+    void end(uint32_t frames)
+    {
+        fRecord.frames = frames;
+        fRecord.ns[kProfileProcess] = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - fStart).count());
+
+        // a reader that falls behind loses records, never the audio thread time
+        fRing.push(fRecord);
+    }
+
+    bool pop(Fl3ngrProfileRecord& record)
+    {
+        return fRing.pop(record);
+    }
+
+private:
+    clock::time_point fStart, fLast;
+    Fl3ngrProfileRecord fRecord = {};
+    Fl3ngrSpscQueue<Fl3ngrProfileRecord, 256> fRing;
+};
+
+/**
+   Reader side: min/avg/max ns per sample of each stage.
+   With a window the values cover the last complete window of blocks (the running one until the first completes),
+   without one they cover everything since the last clear().
+ */
+class Fl3ngrProfileCounters
+{
+public:
+    explicit Fl3ngrProfileCounters(uint32_t windowBlocks = 0)
+        : fWindowBlocks(windowBlocks)
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        fRunning = Window();
+        fDone = Window();
+    }
+
+    void collect(Fl3ngrProfiler& profiler)
+    {
+        Fl3ngrProfileRecord record;
+        while (profiler.pop(record))
+        {
+            if (record.frames == 0)
+                continue;
+
+            for (uint32_t s = 0; s < kProfileStageCount; ++s)
+            {
+                const double perSample = static_cast<double>(record.ns[s]) / record.frames;
+                fRunning.min[s] = std::min(fRunning.min[s], perSample);
+                fRunning.max[s] = std::max(fRunning.max[s], perSample);
+                fRunning.ns[s] += record.ns[s];
+            }
+            fRunning.frames += record.frames;
+
+            if (++fRunning.blocks == fWindowBlocks)
+            {
+                fDone = fRunning;
+                fRunning = Window();
+            }
+        }
+    }
+
+    float get(uint32_t stage, uint32_t value) const
+    {
+        const Window& w(fDone.blocks != 0 ? fDone : fRunning);
+        if (w.blocks == 0)
+            return 0.0f;
+
+        switch (value)
+        {
+        case kProfileMin: return static_cast<float>(w.min[stage]);
+        case kProfileMax: return static_cast<float>(w.max[stage]);
+        default:          return static_cast<float>(w.ns[stage] / w.frames);
+        }
+    }
+
+    uint64_t blocks() const
+    {
+        return fDone.blocks != 0 ? fDone.blocks : fRunning.blocks;
+    }
+
+private:
+    struct Window
+    {
+        double min[kProfileStageCount];
+        double max[kProfileStageCount];
+        double ns[kProfileStageCount];
+        double frames = 0.0;
+        uint64_t blocks = 0;
+
+        Window()
+        {
+            std::fill(min, min + kProfileStageCount, 1e30);
+            std::fill(max, max + kProfileStageCount, 0.0);
+            std::fill(ns, ns + kProfileStageCount, 0.0);
+        }
+    };
+
+    const uint32_t fWindowBlocks;
+    Window fRunning, fDone;
+};
+
+#else
+
+class Fl3ngrProfiler
+{
+public:
+    static constexpr bool kEnabled = false;
+
+    void begin() {}
+    uint32_t lap() { return 0; }
+    void add(uint32_t, uint32_t) {}
+    void mark(uint32_t) {}
+    void end(uint32_t) {}
+};
+
+class Fl3ngrProfileCounters
+{
+public:
+    explicit Fl3ngrProfileCounters(uint32_t = 0) {}
+    void clear() {}
+    void collect(Fl3ngrProfiler&) {}
+    float get(uint32_t, uint32_t) const { return 0.0f; }
+    uint64_t blocks() const { return 0; }
+};
+
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
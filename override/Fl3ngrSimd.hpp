@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define FL3NGR_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define FL3NGR_SIMD_NEON 1
+#elif defined(__wasm_simd128__)
+# include <wasm_simd128.h>
+# define FL3NGR_SIMD_WASM 1
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Four float lanes, the unit the engine processes band-channel pairs in.
+// Fl3ngrScalar4 is the portable fallback and the reference the vector versions are checked against,
+// every operation is lane-wise and matches it bit for bit.
+
+struct Fl3ngrScalar4
+{
+    float v[4];
+
+    static const char* name() { return "scalar"; }
+
+    static Fl3ngrScalar4 load(const float* p)
+    {
+        return { { p[0], p[1], p[2], p[3] } };
+    }
+
+    static Fl3ngrScalar4 set(float a, float b, float c, float d)
+    {
+        return { { a, b, c, d } };
+    }
+
+    static Fl3ngrScalar4 set1(float a)
+    {
+        return { { a, a, a, a } };
+    }
+
+    void store(float* p) const
+    {
+        p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3];
+    }
+
+#define FL3NGR_SCALAR4_OP(expr) \
+    Fl3ngrScalar4 r; for (int i = 0; i < 4; ++i) r.v[i] = (expr); return r;
+
+    friend Fl3ngrScalar4 operator+(Fl3ngrScalar4 a, Fl3ngrScalar4 b) { FL3NGR_SCALAR4_OP(a.v[i] + b.v[i]) }
+    friend Fl3ngrScalar4 operator-(Fl3ngrScalar4 a, Fl3ngrScalar4 b) { FL3NGR_SCALAR4_OP(a.v[i] - b.v[i]) }
+    friend Fl3ngrScalar4 operator*(Fl3ngrScalar4 a, Fl3ngrScalar4 b) { FL3NGR_SCALAR4_OP(a.v[i] * b.v[i]) }
+    friend Fl3ngrScalar4 min(Fl3ngrScalar4 a, Fl3ngrScalar4 b) { FL3NGR_SCALAR4_OP(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+    friend Fl3ngrScalar4 max(Fl3ngrScalar4 a, Fl3ngrScalar4 b) { FL3NGR_SCALAR4_OP(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+    friend Fl3ngrScalar4 abs(Fl3ngrScalar4 a) { FL3NGR_SCALAR4_OP(std::fabs(a.v[i])) }
+    friend Fl3ngrScalar4 copysign(Fl3ngrScalar4 mag, Fl3ngrScalar4 sgn) { FL3NGR_SCALAR4_OP(std::copysign(mag.v[i], sgn.v[i])) }
+
+    // zero where the magnitude is below the threshold (or not a number)
+    friend Fl3ngrScalar4 flushBelow(Fl3ngrScalar4 a, Fl3ngrScalar4 t) { FL3NGR_SCALAR4_OP(std::fabs(a.v[i]) >= t.v[i] ? a.v[i] : 0.0f) }
+
+    // phase in [0, 2) wrapped back into [0, 1)
+    friend Fl3ngrScalar4 wrapUnit(Fl3ngrScalar4 p) { FL3NGR_SCALAR4_OP(p.v[i] >= 1.0f ? p.v[i] - 1.0f : p.v[i]) }
+
+#undef FL3NGR_SCALAR4_OP
+};
+
+#if FL3NGR_SIMD_SSE2
+struct Fl3ngrSse4
+{
+    __m128 v;
+
+    static const char* name() { return "sse2"; }
+
+    static Fl3ngrSse4 load(const float* p)                     { return { _mm_loadu_ps(p) }; }
+    static Fl3ngrSse4 set(float a, float b, float c, float d)   { return { _mm_setr_ps(a, b, c, d) }; }
+    static Fl3ngrSse4 set1(float a)                            { return { _mm_set1_ps(a) }; }
+    void store(float* p) const                                 { _mm_storeu_ps(p, v); }
+
+    friend Fl3ngrSse4 operator+(Fl3ngrSse4 a, Fl3ngrSse4 b)    { return { _mm_add_ps(a.v, b.v) }; }
+    friend Fl3ngrSse4 operator-(Fl3ngrSse4 a, Fl3ngrSse4 b)    { return { _mm_sub_ps(a.v, b.v) }; }
+    friend Fl3ngrSse4 operator*(Fl3ngrSse4 a, Fl3ngrSse4 b)    { return { _mm_mul_ps(a.v, b.v) }; }
+    friend Fl3ngrSse4 min(Fl3ngrSse4 a, Fl3ngrSse4 b)          { return { _mm_min_ps(a.v, b.v) }; }
+    friend Fl3ngrSse4 max(Fl3ngrSse4 a, Fl3ngrSse4 b)          { return { _mm_max_ps(a.v, b.v) }; }
+    friend Fl3ngrSse4 abs(Fl3ngrSse4 a)                        { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+
+    friend Fl3ngrSse4 copysign(Fl3ngrSse4 mag, Fl3ngrSse4 sgn)
+    {
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+        return { _mm_or_ps(_mm_andnot_ps(signBit, mag.v), _mm_and_ps(signBit, sgn.v)) };
+    }
+
+    friend Fl3ngrSse4 wrapUnit(Fl3ngrSse4 p)
+    {
+        const __m128 one = _mm_set1_ps(1.0f);
+        return { _mm_sub_ps(p.v, _mm_and_ps(_mm_cmpge_ps(p.v, one), one)) };
+    }
+
+    friend Fl3ngrSse4 flushBelow(Fl3ngrSse4 a, Fl3ngrSse4 t)
+    {
+        return { _mm_and_ps(a.v, _mm_cmpge_ps(abs(a).v, t.v)) };
+    }
+};
+typedef Fl3ngrSse4 Fl3ngrVec4;
+#elif FL3NGR_SIMD_NEON
+struct Fl3ngrNeon4
+{
+    float32x4_t v;
+
+    static const char* name() { return "neon"; }
+
+    static Fl3ngrNeon4 load(const float* p)                    { return { vld1q_f32(p) }; }
+    static Fl3ngrNeon4 set1(float a)                           { return { vdupq_n_f32(a) }; }
+    void store(float* p) const                                 { vst1q_f32(p, v); }
+
+    static Fl3ngrNeon4 set(float a, float b, float c, float d)
+    {
+        const float p[4] = { a, b, c, d };
+        return load(p);
+    }
+
+    friend Fl3ngrNeon4 operator+(Fl3ngrNeon4 a, Fl3ngrNeon4 b) { return { vaddq_f32(a.v, b.v) }; }
+    friend Fl3ngrNeon4 operator-(Fl3ngrNeon4 a, Fl3ngrNeon4 b) { return { vsubq_f32(a.v, b.v) }; }
+    friend Fl3ngrNeon4 operator*(Fl3ngrNeon4 a, Fl3ngrNeon4 b) { return { vmulq_f32(a.v, b.v) }; }
+    friend Fl3ngrNeon4 min(Fl3ngrNeon4 a, Fl3ngrNeon4 b)       { return { vminq_f32(a.v, b.v) }; }
+    friend Fl3ngrNeon4 max(Fl3ngrNeon4 a, Fl3ngrNeon4 b)       { return { vmaxq_f32(a.v, b.v) }; }
+    friend Fl3ngrNeon4 abs(Fl3ngrNeon4 a)                      { return { vabsq_f32(a.v) }; }
+
+    friend Fl3ngrNeon4 copysign(Fl3ngrNeon4 mag, Fl3ngrNeon4 sgn)
+    {
+        return { vbslq_f32(vdupq_n_u32(0x80000000u), sgn.v, mag.v) };
+    }
+
+    friend Fl3ngrNeon4 wrapUnit(Fl3ngrNeon4 p)
+    {
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        return { vbslq_f32(vcgeq_f32(p.v, one), vsubq_f32(p.v, one), p.v) };
+    }
+
+    friend Fl3ngrNeon4 flushBelow(Fl3ngrNeon4 a, Fl3ngrNeon4 t)
+    {
+        return { vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vcgeq_f32(vabsq_f32(a.v), t.v))) };
+    }
+};
+typedef Fl3ngrNeon4 Fl3ngrVec4;
+#elif FL3NGR_SIMD_WASM
+// WebAssembly SIMD128 (emcc -msimd128). Its min/max propagate NaN and order the zeros, the pseudo ones are the
+// plain compare and select the scalar version does, given the operands the other way round.
+struct Fl3ngrWasm4
+{
+    v128_t v;
+
+    static const char* name() { return "wasm-simd128"; }
+
+    static Fl3ngrWasm4 load(const float* p)                    { return { wasm_v128_load(p) }; }
+    static Fl3ngrWasm4 set(float a, float b, float c, float d)  { return { wasm_f32x4_make(a, b, c, d) }; }
+    static Fl3ngrWasm4 set1(float a)                           { return { wasm_f32x4_splat(a) }; }
+    void store(float* p) const                                 { wasm_v128_store(p, v); }
+
+    friend Fl3ngrWasm4 operator+(Fl3ngrWasm4 a, Fl3ngrWasm4 b) { return { wasm_f32x4_add(a.v, b.v) }; }
+    friend Fl3ngrWasm4 operator-(Fl3ngrWasm4 a, Fl3ngrWasm4 b) { return { wasm_f32x4_sub(a.v, b.v) }; }
+    friend Fl3ngrWasm4 operator*(Fl3ngrWasm4 a, Fl3ngrWasm4 b) { return { wasm_f32x4_mul(a.v, b.v) }; }
+    friend Fl3ngrWasm4 min(Fl3ngrWasm4 a, Fl3ngrWasm4 b)       { return { wasm_f32x4_pmin(b.v, a.v) }; }
+    friend Fl3ngrWasm4 max(Fl3ngrWasm4 a, Fl3ngrWasm4 b)       { return { wasm_f32x4_pmax(b.v, a.v) }; }
+    friend Fl3ngrWasm4 abs(Fl3ngrWasm4 a)                      { return { wasm_f32x4_abs(a.v) }; }
+
+    friend Fl3ngrWasm4 copysign(Fl3ngrWasm4 mag, Fl3ngrWasm4 sgn)
+    {
+        return { wasm_v128_bitselect(sgn.v, mag.v, wasm_f32x4_splat(-0.0f)) };
+    }
+
+    friend Fl3ngrWasm4 wrapUnit(Fl3ngrWasm4 p)
+    {
+        const v128_t one = wasm_f32x4_splat(1.0f);
+        return { wasm_f32x4_sub(p.v, wasm_v128_and(wasm_f32x4_ge(p.v, one), one)) };
+    }
+
+    friend Fl3ngrWasm4 flushBelow(Fl3ngrWasm4 a, Fl3ngrWasm4 t)
+    {
+        return { wasm_v128_and(a.v, wasm_f32x4_ge(wasm_f32x4_abs(a.v), t.v)) };
+    }
+};
+typedef Fl3ngrWasm4 Fl3ngrVec4;
+#else
+typedef Fl3ngrScalar4 Fl3ngrVec4;
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   sin(2 pi p) for a phase p in [0, 1).
+   Folded onto a quarter period and evaluated as a cosine polynomial, the error stays below 5e-7.
+ */
+template <class V>
+static inline V fl3ngrSin2Pi(V p)
+{
+    const V x = p - V::set1(0.5f);
+    const V u = abs(x) - V::set1(0.25f);
+    const V t = u * u;
+
+    V c = V::set1(-26.426256783374388f);
+    c = c * t + V::set1(60.24464137187664f);
+    c = c * t + V::set1(-85.45681720669371f);
+    c = c * t + V::set1(64.93939402266828f);
+    c = c * t + V::set1(-19.739208802178716f);
+    c = c * t + V::set1(1.0f);
+
+    // sin(2 pi p) = -sin(2 pi x), and sin(2 pi |x|) = cos(2 pi u)
+    return copysign(c, V::set1(0.0f) - x);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
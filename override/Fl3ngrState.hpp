@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "Fl3ngrEngine.hpp"
+
+// --------------------------------------------------------------------------------------------------------------------
+// Plugin state
+//
+// Two keys make up the saved state. "parameters" holds every parameter as one `<symbol> <value>` line, so a
+// session or preset restores as one set that the engine applies in a single block (Fl3ngrEngineT::setParameters()).
+// Symbols it does not know are skipped and parameters it does not mention keep their defaults, so states survive
+// parameters being added or a build with another band count reading them. "ranges" holds the editor's speed range
+// toggles, a '0' (slow) or '1' (fast) per band from the highest down.
+//
+// Values are written and read with a '.' whatever locale the host runs in: a host that sets a German locale would
+// otherwise save "0,5", which a host in the C locale reads as 0.
+
+static const char* const kFl3ngrStateParameters = "parameters";
+static const char* const kFl3ngrStateRanges = "ranges";
+
+/**
+   Format a value with 9 significant digits, enough to read back the same float, and a '.' for the decimal point.
+ */
+static inline void fl3ngrFormatValue(char* text, size_t size, float value)
+{
+    std::snprintf(text, size, "%.9g", value);
+
+    // the locale's decimal point, ',' in many, never more than one per number
+    const char* const point = std::localeconv()->decimal_point;
+    const size_t pointLength = std::strlen(point);
+    if (pointLength == 0 || std::strcmp(point, ".") == 0)
+        return;
+
+    char* const found = std::strstr(text, point);
+    if (found != nullptr)
+    {
+        *found = '.';
+        std::memmove(found + 1, found + pointLength, std::strlen(found + pointLength) + 1);
+    }
+}
+
+/**
+   Read a value written by fl3ngrFormatValue(), from at most `length` characters.
+ */
+static inline float fl3ngrParseValue(const char* text, size_t length)
+{
+    char number[64];
+    const char* const point = std::localeconv()->decimal_point;
+    const size_t pointLength = std::max<size_t>(1, std::strlen(point));
+    size_t n = 0;
+
+    for (size_t i = 0; i < length && text[i] != '\0' && n + pointLength < sizeof(number); ++i)
+    {
+        if (text[i] == '.' && point[0] != '\0')
+        {
+            std::memcpy(number + n, point, pointLength);
+            n += pointLength;
+        }
+        else
+        {
+            number[n++] = text[i];
+        }
+    }
+
+    number[n] = '\0';
+    return std::strtof(number, nullptr);
+}
+
+static inline std::string fl3ngrWriteParameters(const float* values)
+{
+    std::string text;
+    char value[32];
+
+    for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+    {
+        fl3ngrFormatValue(value, sizeof(value), values[i]);
+        text += kFl3ngrParameters[i].symbol;
+        text += ' ';
+        text += value;
+        text += '\n';
+    }
+
+    return text;
+}
+
+/**
+   Parse a "parameters" state into values, defaults first and every value clamped to its range.
+ */
+static inline void fl3ngrReadParameters(const char* text, float* values)
+{
+    for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+        values[i] = kFl3ngrParameters[i].def;
+
+    while (*text != '\0')
+    {
+        const char* const end = std::strchr(text, '\n');
+        const size_t length = end != nullptr ? static_cast<size_t>(end - text) : std::strlen(text);
+        const char* const space = static_cast<const char*>(std::memchr(text, ' ', length));
+
+        if (space != nullptr)
+        {
+            const size_t symbolLength = static_cast<size_t>(space - text);
+
+            for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+            {
+                const Fl3ngrParameterInfo& info(kFl3ngrParameters[i]);
+                if (std::strlen(info.symbol) != symbolLength || std::strncmp(info.symbol, text, symbolLength) != 0)
+                    continue;
+
+                const float value = fl3ngrParseValue(space + 1, length - symbolLength - 1);
+                values[i] = std::max(info.min, std::min(info.max, value));
+                break;
+            }
+        }
+
+        text += length;
+        if (*text == '\n')
+            ++text;
+    }
+}
+
+static inline std::string fl3ngrWriteRanges(const bool* ranges)
+{
+    std::string text(kFl3ngrBandCount, '0');
+    for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+        if (ranges[b])
+            text[b] = '1';
+    return text;
+}
+
+static inline void fl3ngrReadRanges(const char* text, bool* ranges)
+{
+    const size_t length = std::strlen(text);
+    for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+        ranges[b] = b < length && text[b] == '1';
+}
+
+// --------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Fl3ngrBands.hpp"
+
+// --------------------------------------------------------------------------------------------------------------------
+// Band meters for the editor.
+//
+// The engine folds every running band's output into a peak and a sum of squares. About kRate times a second it
+// makes a record of those and each band's LFO phase and current delay. The plugin takes the record after process(),
+// on the audio thread, and hands it to the UI as hidden output parameters, which hosts read on that thread too.
+// A sleeping engine publishes one record of silence and then none until it wakes up.
+
+enum Fl3ngrTelemetryValues
+{
+    kTelemetryPeak,   // linear, both channels
+    kTelemetryRms,    // linear, both channels
+    kTelemetryPhase,  // LFO phase, 0 to 1
+    kTelemetryDelay,  // ms
+    kTelemetryValueCount
+};
+
+// bands in engine order, named by their kFl3ngrBands symbol
+static const uint32_t kFl3ngrTelemetryBandCount = kFl3ngrBandCount;
+static const uint32_t kFl3ngrTelemetryParameterCount = kFl3ngrTelemetryBandCount * kTelemetryValueCount;
+
+static const char* const kFl3ngrTelemetryValueNames[kTelemetryValueCount] = { "peak", "rms", "phase", "delay" };
+
+struct Fl3ngrTelemetryRecord
+{
+    float values[kFl3ngrTelemetryBandCount][kTelemetryValueCount];
+};
+
+class Fl3ngrTelemetry
+{
+public:
+    static constexpr double kRate = 30.0;
+
+    void setSampleRate(double sampleRate)
+    {
+        fPeriod = std::max(1u, static_cast<uint32_t>(sampleRate / kRate));
+        clear();
+    }
+
+    void clear()
+    {
+        std::fill(fPeak, fPeak + kFl3ngrTelemetryBandCount, 0.0f);
+        std::fill(fSquares, fSquares + kFl3ngrTelemetryBandCount, 0.0f);
+        fFrames = 0;
+    }
+
+   /**
+      Book one chunk of a band's output, its peak and the sum of squares over both channels.
+    */
+    void addLevel(uint32_t band, float peak, float squares)
+    {
+        fPeak[band] = std::max(fPeak[band], peak);
+        fSquares[band] += squares;
+    }
+
+   /**
+      Count frames processed, true when a record is due. Publish it with publish().
+    */
+    bool advance(uint32_t frames)
+    {
+        fFrames += frames;
+        return fFrames >= fPeriod;
+    }
+
+    void publish(const float* phases, const float* delaysMs)
+    {
+        for (uint32_t b = 0; b < kFl3ngrTelemetryBandCount; ++b)
+        {
+            fRecord.values[b][kTelemetryPeak] = fPeak[b];
+            fRecord.values[b][kTelemetryRms] = fFrames > 0 ? std::sqrt(fSquares[b] / (2 * fFrames)) : 0.0f;
+            fRecord.values[b][kTelemetryPhase] = phases[b];
+            fRecord.values[b][kTelemetryDelay] = delaysMs[b];
+        }
+
+        fFresh = true;
+        clear();
+    }
+
+   /**
+      Copy the record published since the last call, false when there is none.
+      From the thread that processes, between process() calls.
+    */
+    bool take(Fl3ngrTelemetryRecord& record)
+    {
+        if (! fFresh)
+            return false;
+
+        record = fRecord;
+        fFresh = false;
+        return true;
+    }
+
+private:
+    uint32_t fPeriod = 1600;
+    uint32_t fFrames = 0;
+    float fPeak[kFl3ngrTelemetryBandCount] = {};
+    float fSquares[kFl3ngrTelemetryBandCount] = {};
+    Fl3ngrTelemetryRecord fRecord = {};
+    bool fFresh = false;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
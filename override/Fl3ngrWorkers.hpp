@@ -0,0 +1,317 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Fl3ngrDenormals.hpp"
+
+// `make PARALLEL=true` builds the worker threads in, without them the engine always renders on one thread
+#ifndef FL3NGR_PARALLEL
+# define FL3NGR_PARALLEL 0
+#endif
+
+// web builds only have threads with emscripten's pthreads
+#if FL3NGR_PARALLEL && defined(__EMSCRIPTEN__) && ! defined(__EMSCRIPTEN_PTHREADS__)
+# undef FL3NGR_PARALLEL
+# define FL3NGR_PARALLEL 0
+#endif
+
+#if FL3NGR_PARALLEL
+# include <thread>
+# include <vector>
+# if defined(_WIN32)
+#  ifndef NOMINMAX
+#   define NOMINMAX
+#  endif
+#  include <windows.h>
+# elif defined(__APPLE__)
+#  include <dispatch/dispatch.h>
+# else
+#  include <cerrno>
+#  include <semaphore.h>
+# endif
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#if FL3NGR_PARALLEL
+/**
+   Counting semaphore of the platform. Posting takes no lock in user space, so the audio thread can wake a thread
+   with it, like LV2 hosts wake their worker threads.
+ */
+class Fl3ngrSemaphore
+{
+public:
+    Fl3ngrSemaphore()
+    {
+# if defined(_WIN32)
+        fHandle = CreateSemaphoreW(nullptr, 0, 0x7fffffff, nullptr);
+# elif defined(__APPLE__)
+        fHandle = dispatch_semaphore_create(0);
+# else
+        sem_init(&fHandle, 0, 0);
+# endif
+    }
+
+    ~Fl3ngrSemaphore()
+    {
+# if defined(_WIN32)
+        CloseHandle(fHandle);
+# elif defined(__APPLE__)
+        dispatch_release(fHandle);
+# else
+        sem_destroy(&fHandle);
+# endif
+    }
+
+    void post()
+    {
+# if defined(_WIN32)
+        ReleaseSemaphore(fHandle, 1, nullptr);
+# elif defined(__APPLE__)
+        dispatch_semaphore_signal(fHandle);
+# else
+        sem_post(&fHandle);
+# endif
+    }
+
+    void wait()
+    {
+# if defined(_WIN32)
+        WaitForSingleObject(fHandle, INFINITE);
+# elif defined(__APPLE__)
+        dispatch_semaphore_wait(fHandle, DISPATCH_TIME_FOREVER);
+# else
+        while (sem_wait(&fHandle) != 0 && errno == EINTR) {}
+# endif
+    }
+
+private:
+# if defined(_WIN32)
+    HANDLE fHandle;
+# elif defined(__APPLE__)
+    dispatch_semaphore_t fHandle;
+# else
+    sem_t fHandle;
+# endif
+
+    Fl3ngrSemaphore(const Fl3ngrSemaphore&) = delete;
+    Fl3ngrSemaphore& operator=(const Fl3ngrSemaphore&) = delete;
+};
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   A few persistent threads that take tasks next to the thread that hands them out.
+   Between wake() and sleep(), the length of one offline block, the workers spin for work a while, so handing out
+   the tasks of every chunk costs no system call. A worker that finds none for kSpins pauses and kYields yields, or
+   any outside such a block, waits on a semaphore, so none keeps a core busy for longer than that. None of wake(),
+   run() and sleep() takes a lock or allocates, wake() and run() post the semaphore once for every worker that waits
+   on it. Tasks are claimed
+   from one atomic ticket that holds the batch, its task count and the next task, so a worker that is late for one
+   batch can never take a task of the next. Workers run with the floating point mode of the thread that woke them, flush-to-zero included.
+   Builds without FL3NGR_PARALLEL have no threads and run() does every task itself.
+ */
+class Fl3ngrWorkers
+{
+public:
+    typedef void (*Task)(void* context, uint32_t index);
+
+    Fl3ngrWorkers() = default;
+
+    ~Fl3ngrWorkers()
+    {
+        stop();
+    }
+
+    // threads besides the one calling run()
+    uint32_t size() const
+    {
+#if FL3NGR_PARALLEL
+        return static_cast<uint32_t>(fThreads.size());
+#else
+        return 0;
+#endif
+    }
+
+    // start `count` threads in place of the running ones, this allocates so it never runs on the audio thread
+    void start(uint32_t count)
+    {
+        stop();
+#if FL3NGR_PARALLEL
+        fQuit.store(false);
+        for (uint32_t i = 0; i < count; ++i)
+            fThreads.emplace_back(&Fl3ngrWorkers::loop, this);
+#else
+        (void)count;
+#endif
+    }
+
+    void stop()
+    {
+#if FL3NGR_PARALLEL
+        fQuit.store(true);
+        for (size_t i = 0; i < fThreads.size(); ++i)
+            fWakeUp.post();
+
+        for (std::thread& thread : fThreads)
+            thread.join();
+        fThreads.clear();
+#endif
+    }
+
+    void wake()
+    {
+#if FL3NGR_PARALLEL
+        fFloatMode.store(fl3ngrFloatMode(), std::memory_order_relaxed);
+        fAwake.store(true);
+        postWaiting();
+#endif
+    }
+
+    void sleep()
+    {
+#if FL3NGR_PARALLEL
+        fAwake.store(false);
+#endif
+    }
+
+    // task(context, i) for every i below count, returns once all of them have finished
+    void run(Task task, void* context, uint32_t count)
+    {
+#if FL3NGR_PARALLEL
+        fTask = task;
+        fContext = context;
+        fDone.store(0, std::memory_order_relaxed);
+        const uint64_t batch = ++fBatch;
+        fTicket.store(batch << 32 | static_cast<uint64_t>(count) << 16);
+        postWaiting();
+
+        uint32_t index;
+        while (claim(index))
+        {
+            task(context, index);
+            fDone.fetch_add(1, std::memory_order_release);
+        }
+
+        for (uint32_t spins = 0; fDone.load(std::memory_order_acquire) != count; ++spins)
+            relax(spins);
+#else
+        for (uint32_t i = 0; i < count; ++i)
+            task(context, i);
+#endif
+    }
+
+private:
+#if FL3NGR_PARALLEL
+    // a worker that counts itself after this still sees the work or fAwake and does not wait
+    void postWaiting()
+    {
+        for (uint32_t waiting = fWaiting.exchange(0); waiting != 0; --waiting)
+            fWakeUp.post();
+    }
+
+    bool hasWork() const
+    {
+        const uint64_t ticket = fTicket.load();
+        return (ticket & 0xffff) < (ticket >> 16 & 0xffff);
+    }
+
+    bool claim(uint32_t& index)
+    {
+        uint64_t ticket = fTicket.load(std::memory_order_acquire);
+
+        for (;;)
+        {
+            index = static_cast<uint32_t>(ticket & 0xffff);
+            if (index >= (ticket >> 16 & 0xffff))
+                return false;
+            if (fTicket.compare_exchange_weak(ticket, ticket + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                return true;
+        }
+    }
+
+    // spin a while, then give the core away in case the thread being waited for needs it
+    static void relax(uint32_t spins)
+    {
+# if FL3NGR_SIMD_SSE2 || defined(__SSE__)
+        if (spins < kSpins)
+        {
+            _mm_pause();
+            return;
+        }
+# else
+        (void)spins;
+# endif
+        std::this_thread::yield();
+    }
+
+    void loop()
+    {
+        uint64_t mode = fl3ngrFloatMode();
+        uint32_t spins = 0;
+
+        for (;;)
+        {
+            uint32_t index;
+            if (claim(index))
+            {
+                spins = 0;
+
+                const uint64_t wanted = fFloatMode.load(std::memory_order_relaxed);
+                if (wanted != mode)
+                {
+                    fl3ngrSetFloatMode(wanted);
+                    mode = wanted;
+                }
+
+                fTask(fContext, index);
+                fDone.fetch_add(1, std::memory_order_release);
+                continue;
+            }
+
+            if (fQuit.load())
+                return;
+
+            if (fAwake.load() && spins < kSpins + kYields)
+            {
+                relax(spins++);
+                continue;
+            }
+
+            // counted before looking for work again, so run() either sees the count or this sees its tasks, and
+            // outside a block wake() sees the count or this sees it awake. A post left over from either second case
+            // only makes the next wait return early
+            fWaiting.fetch_add(1);
+            if (! hasWork() && (! fAwake.load() || spins == kSpins + kYields) && ! fQuit.load())
+                fWakeUp.wait();
+            spins = 0;
+        }
+    }
+
+    static constexpr uint32_t kSpins = 1024;
+    static constexpr uint32_t kYields = 64;
+
+    std::vector<std::thread> fThreads;
+    Fl3ngrSemaphore fWakeUp;
+    std::atomic<uint32_t> fWaiting { 0 };  // workers that may be waiting on fWakeUp
+    std::atomic<bool> fAwake { false };
+    std::atomic<bool> fQuit { false };
+    std::atomic<uint64_t> fFloatMode { 0 };
+    std::atomic<uint64_t> fTicket { 0 };  // batch << 32 | task count << 16 | next task
+    std::atomic<uint32_t> fDone { 0 };
+    uint32_t fBatch = 0;
+    Task fTask = nullptr;
+    void* fContext = nullptr;
+#endif
+
+    Fl3ngrWorkers(const Fl3ngrWorkers&) = delete;
+    Fl3ngrWorkers& operator=(const Fl3ngrWorkers&) = delete;
+};
+
+// --------------------------------------------------------------------------------------------------------------------
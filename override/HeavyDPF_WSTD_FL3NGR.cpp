@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#include "HeavyDPF_WSTD_FL3NGR.hpp"
+
+#if FL3NGR_PARALLEL
+# include <thread>
+#endif
+
+// the Makefile's pregen step adds these to the generated plugin info, without them hosts would never hear of the
+// latency and Sync would never see the transport
+#if ! DISTRHO_PLUGIN_WANT_LATENCY || ! DISTRHO_PLUGIN_WANT_TIMEPOS
+# error "DistrhoPluginInfo.h must define DISTRHO_PLUGIN_WANT_LATENCY and _TIMEPOS 1, regenerate it with 'make pregen'"
+#endif
+
+START_NAMESPACE_DISTRHO
+
+// --------------------------------------------------------------------------------------------------------------------
+
+HeavyDPF_WSTD_FL3NGR::HeavyDPF_WSTD_FL3NGR()
+    : Plugin(kFl3ngrPluginParameterCount, 0, DISTRHO_PLUGIN_WANT_STATE ? kStateCount : 0),
+      fProfile(kProfileWindowBlocks),
+      fRanges(std::string(kFl3ngrBandCount, '0').c_str())
+{
+    fEngine.setSampleRate(getSampleRate());
+
+#if FL3NGR_BAND_COUNT == 3
+    fPatch.setSampleRate(getSampleRate());
+    fEngine.setPatch(&fPatch);
+#endif
+
+#if FL3NGR_PARALLEL
+    // the workers wait on a semaphore until Render is set to Offline, instances that only describe the plugin
+    // start none
+    if (! isDummyInstance())
+        fEngine.setRenderThreads(std::max(1u, std::thread::hardware_concurrency()));
+#endif
+}
+
+HeavyDPF_WSTD_FL3NGR::~HeavyDPF_WSTD_FL3NGR()
+{
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Init
+
+void HeavyDPF_WSTD_FL3NGR::initParameter(uint32_t index, Parameter& parameter)
+{
+    if (index >= kFl3ngrTelemetryParameterOffset)
+    {
+        if (index >= kFl3ngrPluginParameterCount)
+            return;
+
+        // band meters for the editor
+        static const char* const units[kTelemetryValueCount] = { "", "", "", "ms" };
+        static const float maxima[kTelemetryValueCount] = { 8.0f, 8.0f, 1.0f, 100.0f };
+        const uint32_t band = (index - kFl3ngrTelemetryParameterOffset) / kTelemetryValueCount;
+        const uint32_t value = (index - kFl3ngrTelemetryParameterOffset) % kTelemetryValueCount;
+
+        parameter.hints = kParameterIsOutput | kParameterIsHidden;
+        parameter.name = String("Meter ") + kFl3ngrBands[band].symbol + " " + kFl3ngrTelemetryValueNames[value];
+        parameter.symbol = String("meter_") + kFl3ngrBands[band].symbol + "_" + kFl3ngrTelemetryValueNames[value];
+        parameter.unit = units[value];
+        parameter.ranges.min = 0.0f;
+        parameter.ranges.max = maxima[value];
+        parameter.ranges.def = 0.0f;
+        return;
+    }
+
+    if (index >= kFl3ngrParameterCount)
+    {
+
+        // profiling build: min/avg/max ns per sample of each stage, for the UI's diagnostics overlay
+        static const char* const valueNames[kProfileValueCount] = { "min", "avg", "max" };
+        const uint32_t stage = (index - kFl3ngrParameterCount) / kProfileValueCount;
+        const uint32_t value = (index - kFl3ngrParameterCount) % kProfileValueCount;
+
+        parameter.hints = kParameterIsOutput | kParameterIsHidden;
+        parameter.name = String("Profile ") + kFl3ngrProfileStageNames[stage] + " " + valueNames[value];
+        parameter.symbol = String("profile_") + kFl3ngrProfileStageNames[stage] + "_" + valueNames[value];
+        parameter.unit = "ns";
+        parameter.ranges.min = 0.0f;
+        parameter.ranges.max = 1e6f;
+        parameter.ranges.def = 0.0f;
+        return;
+    }
+
+    const Fl3ngrParameterInfo& info(kFl3ngrParameters[index]);
+
+    parameter.hints = kParameterIsAutomatable;
+    if (info.hints & kFl3ngrHintLogarithmic)
+        parameter.hints |= kParameterIsLogarithmic;
+
+    parameter.name = info.name;
+    parameter.symbol = info.symbol;
+    parameter.unit = info.unit;
+    parameter.ranges.min = info.min;
+    parameter.ranges.max = info.max;
+    parameter.ranges.def = info.def;
+
+    if (info.hints & kFl3ngrHintChoice)
+    {
+        // modes that reset or rephase state, keep them out of automation lanes
+        parameter.hints = kParameterIsInteger;
+
+        const char* const* const names = fl3ngrChoiceNames(index);
+        const uint32_t count = static_cast<uint32_t>(info.max - info.min) + 1;
+        ParameterEnumerationValue* const values = new ParameterEnumerationValue[count];
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            values[i].value = info.min + i;
+            values[i].label = names[i];
+        }
+
+        parameter.enumValues.count = count;
+        parameter.enumValues.restrictedMode = true;
+        parameter.enumValues.values = values;
+    }
+
+    if (info.hints & kFl3ngrHintHidden)
+        parameter.hints |= kParameterIsHidden;
+}
+
+#if DISTRHO_PLUGIN_WANT_STATE
+void HeavyDPF_WSTD_FL3NGR::initState(uint32_t index, State& state)
+{
+    switch (index)
+    {
+    case kStateParameters:
+        // every parameter again, so a session or preset restores in one block instead of one value at a time
+        state.key = kFl3ngrStateParameters;
+        state.label = "Parameters";
+        state.hints = kStateIsOnlyForDSP;
+        state.defaultValue = "";
+        break;
+
+    case kStateRanges:
+        // the editor's slow/fast speed toggles
+        state.key = kFl3ngrStateRanges;
+        state.label = "Speed ranges";
+        state.hints = 0;
+        state.defaultValue = std::string(kFl3ngrBandCount, '0').c_str();
+        break;
+    }
+}
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Internal data
+
+float HeavyDPF_WSTD_FL3NGR::getParameterValue(uint32_t index) const
+{
+    if (index >= kFl3ngrTelemetryParameterOffset)
+    {
+        const uint32_t offset = index - kFl3ngrTelemetryParameterOffset;
+        return fTelemetry.values[offset / kTelemetryValueCount][offset % kTelemetryValueCount];
+    }
+
+    if (index >= kFl3ngrParameterCount)
+    {
+        const uint32_t offset = index - kFl3ngrParameterCount;
+        return fProfile.get(offset / kProfileValueCount, offset % kProfileValueCount);
+    }
+
+    return fEngine.getParameter(index);
+}
+
+void HeavyDPF_WSTD_FL3NGR::setParameterValue(uint32_t index, float value)
+{
+    fEngine.setParameter(index, value);
+}
+
+#if DISTRHO_PLUGIN_WANT_STATE
+void HeavyDPF_WSTD_FL3NGR::setState(const char* key, const char* value)
+{
+    if (std::strcmp(key, kFl3ngrStateRanges) == 0)
+    {
+        fRanges = value;
+        return;
+    }
+
+    // an empty state is the default one, it must not reset what the host set parameter by parameter
+    if (std::strcmp(key, kFl3ngrStateParameters) == 0 && *value != '\0')
+    {
+        float values[kFl3ngrParameterCount];
+        fl3ngrReadParameters(value, values);
+        fEngine.setParameters(values);
+    }
+}
+#endif
+
+#if DISTRHO_PLUGIN_WANT_FULL_STATE
+String HeavyDPF_WSTD_FL3NGR::getState(const char* key) const
+{
+    if (std::strcmp(key, kFl3ngrStateRanges) == 0)
+        return fRanges;
+
+    if (std::strcmp(key, kFl3ngrStateParameters) == 0)
+    {
+        float values[kFl3ngrParameterCount];
+        for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+            values[i] = fEngine.getParameter(i);
+        return String(fl3ngrWriteParameters(values).c_str());
+    }
+
+    return String();
+}
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Process
+
+void HeavyDPF_WSTD_FL3NGR::activate()
+{
+    fEngine.reset();
+}
+
+void HeavyDPF_WSTD_FL3NGR::run(const float** inputs, float** outputs, uint32_t frames)
+{
+    // the feedback and filter tails decay through the subnormals once the input stops
+    const Fl3ngrScopedFlushToZero ftz;
+
+    const TimePosition& timePos(getTimePosition());
+
+    if (timePos.bbt.valid)
+    {
+        const double beats = (timePos.bbt.bar - 1) * static_cast<double>(timePos.bbt.beatsPerBar)
+                           + (timePos.bbt.beat - 1)
+                           + timePos.bbt.tick / timePos.bbt.ticksPerBeat;
+        fEngine.setTransport(timePos.playing, beats, timePos.bbt.beatsPerMinute);
+    }
+
+    fEngine.process(inputs[0], inputs[1], outputs[0], outputs[1], frames);
+
+    // a new oversampling factor is picked up inside process(), report its delay before the next block
+    const uint32_t latency = fEngine.getLatency();
+    if (latency != fLatency)
+    {
+        fLatency = latency;
+        setLatency(latency);
+    }
+
+    // unlike the latency, fEngine.getTailFrames() has nowhere to go: DPF answers the VST3 getTailSamples() query
+    // itself and implements no CLAP tail extension, and Plugin offers no call to set either. Hosts that stop
+    // processing a plugin once its input goes quiet cut the echoes off, see the README
+
+    // hosts read the output parameters right after run(), on this thread
+    fProfile.collect(fEngine.getProfiler());
+
+    fEngine.getTelemetry().take(fTelemetry);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// Callbacks
+
+void HeavyDPF_WSTD_FL3NGR::sampleRateChanged(double newSampleRate)
+{
+    fEngine.setSampleRate(newSampleRate);
+#if FL3NGR_BAND_COUNT == 3
+    fPatch.setSampleRate(newSampleRate);
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+Plugin* createPlugin()
+{
+    return new HeavyDPF_WSTD_FL3NGR();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) Wasted Audio 2023 - GPL-3.0-or-later
+ */
+
+#ifndef _HEAVY_DPF_WSTD_FL3NGR_H_
+#define _HEAVY_DPF_WSTD_FL3NGR_H_
+
+#include "DistrhoPlugin.hpp"
+#include "DistrhoPluginInfo.h"
+#include "Fl3ngrEngine.hpp"
+#include "Fl3ngrPatch.hpp"
+#include "Fl3ngrState.hpp"
+
+START_NAMESPACE_DISTRHO
+
+// --------------------------------------------------------------------------------------------------------------------
+
+/**
+   Plugin wrapper around the native FL3NGR engine.
+   Replaces the hvcc generated wrapper, WSTD_FL3NGR.pd stays the reference for parameters and sound and the 3 band
+   build still runs it as the Classic crossover.
+ */
+class HeavyDPF_WSTD_FL3NGR : public Plugin
+{
+public:
+    HeavyDPF_WSTD_FL3NGR();
+    ~HeavyDPF_WSTD_FL3NGR() override;
+
+protected:
+    // ----------------------------------------------------------------------------------------------------------------
+    // Information
+
+    const char* getLabel() const override
+    {
+        return "WSTD_FL" FL3NGR_STRINGIFY(FL3NGR_BAND_COUNT) "NGR";
+    }
+
+    const char* getMaker() const override
+    {
+        return "Wasted Audio";
+    }
+
+    const char* getHomePage() const override
+    {
+        return "https://wasted.audio/software/wstd_fl3ngr";
+    }
+
+    const char* getLicense() const override
+    {
+        return "GPL-3.0-or-later";
+    }
+
+    uint32_t getVersion() const override
+    {
+        return d_version(1, 1, 1);
+    }
+
+    int64_t getUniqueId() const override
+    {
+        // every band count is a plugin of its own, 'Fl3n' for the 3 band one
+        return d_cconst('F', 'l', '0' + FL3NGR_BAND_COUNT, 'n');
+    }
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Init
+
+    void initParameter(uint32_t index, Parameter& parameter) override;
+#if DISTRHO_PLUGIN_WANT_STATE
+    void initState(uint32_t index, State& state) override;
+#endif
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Internal data
+
+    float getParameterValue(uint32_t index) const override;
+    void setParameterValue(uint32_t index, float value) override;
+#if DISTRHO_PLUGIN_WANT_STATE
+    void setState(const char* key, const char* value) override;
+#endif
+#if DISTRHO_PLUGIN_WANT_FULL_STATE
+    String getState(const char* key) const override;
+#endif
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Process
+
+    void activate() override;
+    void run(const float** inputs, float** outputs, uint32_t frames) override;
+
+    // ----------------------------------------------------------------------------------------------------------------
+    // Callbacks
+
+    void sampleRateChanged(double newSampleRate) override;
+
+    // ----------------------------------------------------------------------------------------------------------------
+
+private:
+    // rolling window of the diagnostics counters, in blocks
+    static constexpr uint32_t kProfileWindowBlocks = 256;
+
+    enum States
+    {
+        kStateParameters,
+        kStateRanges,
+        kStateCount
+    };
+
+    Fl3ngrEngine fEngine;
+#if FL3NGR_BAND_COUNT == 3
+    Fl3ngrPatch fPatch;
+#endif
+    Fl3ngrProfileCounters fProfile;
+    Fl3ngrTelemetryRecord fTelemetry = {};
+    uint32_t fLatency = 0;
+    String fRanges;
+
+    DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HeavyDPF_WSTD_FL3NGR)
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // _HEAVY_DPF_WSTD_FL3NGR_H_
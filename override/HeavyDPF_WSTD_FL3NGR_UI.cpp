@@ -9,33 +9,252 @@
 #include "ResizeHandle.hpp"
 #include "veramobd.hpp"
 #include "wstdcolors.hpp"
+#include "Fl3ngrEngine.hpp"
+#include "Fl3ngrState.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if FL3NGR_PROFILE
+# include <chrono>
+#endif
 
 
 START_NAMESPACE_DISTRHO
 
+// height a band adds to the editor, one row of knobs
+static const int kBandRowHeight = 104;
+
+// height of the row of settings under the bands
+static const int kSettingsRowHeight = 56;
+
+// width the band columns the patch has no knobs for add to the editor
+static const int kExtraColumnsWidth = 151;
+
+// label of the crossover frequency knob, the 3 band editor keeps the patch's name for it
+#if FL3NGR_BAND_COUNT == 3
+static const char* const kFreqLabel = "Mid";
+#else
+static const char* const kFreqLabel = "X-over";
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// Font atlas shared by every editor of the process that runs at the same scale factor.
+//
+// The TTF is decompressed and rasterized once, later editors only take a reference. Each editor window still has its
+// own GL context and uploads its own texture from the atlas pixels, so it points the atlas at that texture before
+// drawing. It does so holding the cache's lock until its frame is drawn, so editors that hosts run on other threads
+// wait rather than draw with each other's texture, the atlas is only ever changed for the context drawing with it.
+// The atlas of the last editor closed is kept, reopening one at the same scale does not build it again.
+// No timings have been taken yet, the PROFILE overlay shows how long an editor took to get its fonts.
+
+enum Fl3ngrFonts
+{
+    kFontDefault,
+    kFontTitleBar,
+    kFontSmall,
+    kFontCount
+};
+
+class Fl3ngrFontAtlasCache
+{
+public:
+    static ImFontAtlas* acquire(float scaleFactor)
+    {
+        Fl3ngrFontAtlasCache& cache(instance());
+        std::lock_guard<std::recursive_mutex> lock(cache.fMutex);
+
+        for (Entry& entry : cache.fEntries)
+        {
+            if (entry.scaleFactor == scaleFactor)
+            {
+                ++entry.users;
+                return entry.atlas;
+            }
+        }
+
+        cache.fEntries.push_back({ scaleFactor, build(scaleFactor), 1 });
+        return cache.fEntries.back().atlas;
+    }
+
+    static void release(ImFontAtlas* atlas)
+    {
+        Fl3ngrFontAtlasCache& cache(instance());
+        std::lock_guard<std::recursive_mutex> lock(cache.fMutex);
+
+        for (Entry& entry : cache.fEntries)
+        {
+            if (entry.atlas == atlas && --entry.users == 0)
+            {
+                // keep this one around for the next editor, drop the unused ones of other scales
+                for (size_t i = cache.fEntries.size(); i-- > 0;)
+                {
+                    if (cache.fEntries[i].users == 0 && cache.fEntries[i].atlas != atlas)
+                    {
+                        IM_DELETE(cache.fEntries[i].atlas);
+                        cache.fEntries.erase(cache.fEntries.begin() + i);
+                    }
+                }
+                return;
+            }
+        }
+    }
+
+    static uint32_t users(const ImFontAtlas* atlas)
+    {
+        Fl3ngrFontAtlasCache& cache(instance());
+        std::lock_guard<std::recursive_mutex> lock(cache.fMutex);
+
+        for (const Entry& entry : cache.fEntries)
+            if (entry.atlas == atlas)
+                return entry.users;
+
+        return 0;
+    }
+
+   /**
+      Hold this while pointing an atlas at a texture and drawing a frame with it. Recursive, a frame may ask for
+      users() meanwhile.
+    */
+    static std::unique_lock<std::recursive_mutex> lockForDrawing()
+    {
+        return std::unique_lock<std::recursive_mutex>(instance().fMutex);
+    }
+
+private:
+    struct Entry
+    {
+        float scaleFactor;
+        ImFontAtlas* atlas;
+        uint32_t users;
+    };
+
+    std::vector<Entry> fEntries;
+    std::recursive_mutex fMutex;
+
+    ~Fl3ngrFontAtlasCache()
+    {
+        for (Entry& entry : fEntries)
+            IM_DELETE(entry.atlas);
+    }
+
+    static Fl3ngrFontAtlasCache& instance()
+    {
+        static Fl3ngrFontAtlasCache cache;
+        return cache;
+    }
+
+    static ImFontAtlas* build(float scaleFactor)
+    {
+        static const float kSizes[kFontCount] = { 16.0f, 21.0f, 11.0f };
+
+        ImFontAtlas* const atlas = IM_NEW(ImFontAtlas)();
+
+        ImFontConfig fc;
+        fc.FontDataOwnedByAtlas = true;
+        fc.OversampleH = 1;
+        fc.OversampleV = 1;
+        fc.PixelSnapH = true;
+
+        for (uint32_t i = 0; i < kFontCount; ++i)
+            atlas->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, kSizes[i] * scaleFactor, &fc);
+
+        atlas->Build();
+        return atlas;
+    }
+};
+
 // --------------------------------------------------------------------------------------------------------------------
 
 class ImGuiPluginUI : public UI
 {
-    float fhigh = 0.0f;
-    float fhigh_feedback = 0.0f;
-    float fhigh_intensity = 20.0f;
-    float fhigh_mix = 50.0f;
-    float fhigh_speed = 2.0f;
-    float flow = 0.0f;
-    float flow_feedback = 0.0f;
-    float flow_intensity = 20.0f;
-    float flow_mix = 50.0f;
-    float flow_speed = 2.0f;
-    float fmid = 0.0f;
-    float fmid_feedback = 0.0f;
-    float fmid_freq = 1337.0f;
-    float fmid_intensity = 20.0f;
-    float fmid_mix = 50.0f;
-    float fmid_speed = 2.0f;
-    bool fhigh_range = false;
-    bool flow_range = false;
-    bool fmid_range = false;
+    // knob colors of one band, rebuilt only when the values they are blended from change
+    struct BandColors
+    {
+        bool valid = false;
+        float gain, mix, freq;
+        ImColor active, hovered;
+        ImColor freqActive, freqHovered;
+        ImColor rangeSw, rangeAct, rangeActHv;
+        ImColor mixActive, mixHovered;
+    };
+
+    // one row of knobs per band, in band order
+    struct Band
+    {
+        float values[kFl3ngrBandControlCount];
+        bool range = false;
+        char rangeId[32];
+        BandColors colors;
+    };
+
+    Band fBands[kFl3ngrBandCount];
+    float fFreq;
+    BandColors fFreqColors;
+
+    // the settings row
+    float fCrossover;
+    float fSync;
+    float fOversampling;
+    float fInterpolation;
+
+    // where the host's parameters land, null for the ones without a knob
+    float* fFields[kFl3ngrParameterCount] = {};
+
+    // host updates only mark the UI dirty, uiIdle() turns them into one repaint
+    bool fRepaintPending = false;
+
+    // band meters from the DSP, [band][Fl3ngrTelemetryValues], and the pixel each was last repainted for
+    float fMeters[kFl3ngrTelemetryBandCount][kTelemetryValueCount] = {};
+    int fMeterPixels[kFl3ngrTelemetryBandCount][kTelemetryValueCount] = {};
+    float fMeterHeight = 0.0f;
+
+    // knob edits of the current frame, sent to the host once it is drawn
+    struct OutboundParameter
+    {
+        float value = 0.0f;
+        float sent = 0.0f;
+        bool pending = false;
+        bool gesture = false;
+    };
+
+    OutboundParameter fOutbound[kFl3ngrParameterCount];
+
+    // speed ranges as the plugin state holds them, see Fl3ngrState.hpp
+    std::string fRangesState = std::string(kFl3ngrBandCount, '0');
+
+    // shared fonts, and what the context had before they were swapped in
+    ImGuiContext* fContext;
+    ImFontAtlas* fFontAtlas;
+    ImFontAtlas* fOwnFontAtlas;
+    ImTextureID fFontTexture = ImTextureID();
+
+#if FL3NGR_PROFILE
+    // diagnostics overlay, toggled with ctrl+shift+right click
+    float fProfile[kProfileStageCount][kProfileValueCount] = {};
+    bool fShowProfile = false;
+
+    // time taken to get the fonts when the editor opened
+    double fFontSetupMs = 0.0;
+
+    // knob edits made, values and gestures actually sent to the host
+    uint32_t fEditsQueued = 0;
+    uint32_t fEditsSent = 0;
+    uint32_t fGesturesSent = 0;
+
+    // UI frames drawn and their build time, published once a second
+    struct FrameTimes
+    {
+        uint32_t frames = 0;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    std::chrono::steady_clock::time_point fFrameWindowStart = std::chrono::steady_clock::now();
+    FrameTimes fFrameWindow, fFrameTimes;
+#endif
 
     // ----------------------------------------------------------------------------------------------------------------
 
@@ -45,21 +264,78 @@ public:
       The UI should be initialized to a default state that matches the plugin side.
     */
     ImGuiPluginUI()
-        : UI(DISTRHO_UI_DEFAULT_WIDTH, DISTRHO_UI_DEFAULT_HEIGHT)
+        : UI(DISTRHO_UI_DEFAULT_WIDTH + kExtraColumnsWidth,
+             DISTRHO_UI_DEFAULT_HEIGHT + kSettingsRowHeight + (static_cast<int>(kFl3ngrBandCount) - 3) * kBandRowHeight)
     {
         ImGuiIO& io(ImGui::GetIO());
 
-        ImFontConfig fc;
-        fc.FontDataOwnedByAtlas = true;
-        fc.OversampleH = 1;
-        fc.OversampleV = 1;
-        fc.PixelSnapH = true;
+#if FL3NGR_PROFILE
+        const std::chrono::steady_clock::time_point fontStart = std::chrono::steady_clock::now();
+#endif
 
-        io.Fonts->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, 16.0f * getScaleFactor(), &fc);
-        io.Fonts->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, 21.0f * getScaleFactor(), &fc);
-        io.Fonts->AddFontFromMemoryCompressedTTF((void*)veramobd_compressed_data, veramobd_compressed_size, 11.0f * getScaleFactor(), &fc);
-        io.Fonts->Build();
-        io.FontDefault = io.Fonts->Fonts[1];
+        for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+            fOutbound[i].value = fOutbound[i].sent = kFl3ngrParameters[i].def;
+
+        for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+        {
+            Band& band(fBands[b]);
+
+            for (uint32_t c = 0; c < kFl3ngrBandControlCount; ++c)
+            {
+                const uint32_t index = fl3ngrBandParameter(b, c);
+                band.values[c] = kFl3ngrParameters[index].def;
+                fFields[index] = &band.values[c];
+            }
+
+            std::snprintf(band.rangeId, sizeof(band.rangeId), "##%s_Range", kFl3ngrParameters[fl3ngrBandParameter(b, kBandGain)].receiver);
+        }
+
+        fFreq = kFl3ngrParameters[paramFreq].def;
+        fFields[paramFreq] = &fFreq;
+
+        fCrossover = kFl3ngrParameters[paramCrossover].def;
+        fFields[paramCrossover] = &fCrossover;
+
+        fSync = kFl3ngrParameters[paramSync].def;
+        fFields[paramSync] = &fSync;
+
+        fOversampling = kFl3ngrParameters[paramOversampling].def;
+        fFields[paramOversampling] = &fOversampling;
+
+        fInterpolation = kFl3ngrParameters[paramInterpolation].def;
+        fFields[paramInterpolation] = &fInterpolation;
+
+        fContext = ImGui::GetCurrentContext();
+        fOwnFontAtlas = io.Fonts;
+        fFontAtlas = Fl3ngrFontAtlasCache::acquire(getScaleFactor());
+
+        io.Fonts = fFontAtlas;
+        io.FontDefault = fFontAtlas->Fonts[kFontDefault];
+
+#if FL3NGR_PROFILE
+        fFontSetupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fontStart).count();
+#endif
+
+        ImGuiStyle& style = ImGui::GetStyle();
+        style.WindowTitleAlign = ImVec2(0.5f, 0.5f);
+        style.Colors[ImGuiCol_TitleBgActive] = (ImVec4)WstdTitleBgActive;
+        style.Colors[ImGuiCol_WindowBg] = (ImVec4)WstdWindowBg;
+    }
+
+   /**
+      Hand the context its own atlas back before it is destroyed, the shared one outlives it.
+    */
+    ~ImGuiPluginUI() override
+    {
+        ImGuiContext* const current = ImGui::GetCurrentContext();
+        ImGui::SetCurrentContext(fContext);
+
+        ImGuiIO& io(ImGui::GetIO());
+        io.Fonts = fOwnFontAtlas;
+        io.FontDefault = nullptr;
+
+        ImGui::SetCurrentContext(current);
+        Fl3ngrFontAtlasCache::release(fFontAtlas);
     }
 
 protected:
@@ -72,70 +348,111 @@ protected:
     */
     void parameterChanged(uint32_t index, float value) override
     {
-        switch (index) {
-            case 0:
-                fhigh = value;
-                break;
-            case 1:
-                fhigh_feedback = value;
-                break;
-            case 2:
-                fhigh_intensity = value;
-                break;
-            case 3:
-                fhigh_mix = value;
-                break;
-            case 4:
-                fhigh_speed = value;
-                break;
-            case 5:
-                flow = value;
-                break;
-            case 6:
-                flow_feedback = value;
-                break;
-            case 7:
-                flow_intensity = value;
-                break;
-            case 8:
-                flow_mix = value;
-                break;
-            case 9:
-                flow_speed = value;
-                break;
-            case 10:
-                fmid = value;
-                break;
-            case 11:
-                fmid_feedback = value;
-                break;
-            case 12:
-                fmid_freq = value;
-                break;
-            case 13:
-                fmid_intensity = value;
-                break;
-            case 14:
-                fmid_mix = value;
-                break;
-            case 15:
-                fmid_speed = value;
-                break;
-
-            default: return;
+        float* const field = index < kFl3ngrParameterCount ? fFields[index] : nullptr;
+
+        if (field == nullptr)
+        {
+            if (index >= kFl3ngrTelemetryParameterOffset && index < kFl3ngrPluginParameterCount)
+            {
+                // a meter that moves less than a pixel needs no repaint, an idle editor then stays idle
+                const uint32_t offset = index - kFl3ngrTelemetryParameterOffset;
+                const uint32_t band = offset / kTelemetryValueCount;
+                const uint32_t meter = offset % kTelemetryValueCount;
+                fMeters[band][meter] = value;
+
+                const int pixel = meterPixel(meter, value);
+                if (fMeterPixels[band][meter] != pixel)
+                {
+                    fMeterPixels[band][meter] = pixel;
+                    fRepaintPending = true;
+                }
+                return;
+            }
+#if FL3NGR_PROFILE
+            if (index >= kFl3ngrParameterCount && index < kFl3ngrParameterCount + kFl3ngrProfileParameterCount)
+            {
+                const uint32_t offset = index - kFl3ngrParameterCount;
+                fProfile[offset / kProfileValueCount][offset % kProfileValueCount] = value;
+                if (fShowProfile)
+                    fRepaintPending = true;
+            }
+#endif
+            return;
         }
 
+        // what the host holds now, edits are only sent when they move away from it
+        if (! fOutbound[index].pending)
+            fOutbound[index].sent = value;
+
+        // hosts echo values back and resend unchanged ones during playback, those cost nothing
+        if (*field == value)
+            return;
+
+        *field = value;
+        fRepaintPending = true;
+    }
+
+#if DISTRHO_PLUGIN_WANT_STATE
+   /**
+      A state has changed on the plugin side, the speed ranges are the only one the editor shows.
+    */
+    void stateChanged(const char* key, const char* value) override
+    {
+        if (std::strcmp(key, kFl3ngrStateRanges) != 0)
+            return;
+
+        bool ranges[kFl3ngrBandCount];
+        fl3ngrReadRanges(value, ranges);
+        for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+            fBands[b].range = ranges[b];
+
+        // what the plugin holds now, not sent back
+        fRangesState = fl3ngrWriteRanges(ranges);
+        fRepaintPending = true;
+    }
+#endif
+
+   /**
+      Idle callback, at most one repaint per tick however many parameters changed since the last one.
+    */
+    void uiIdle() override
+    {
+        if (! fRepaintPending)
+            return;
+
+        fRepaintPending = false;
         repaint();
     }
 
     // ----------------------------------------------------------------------------------------------------------------
     // Widget Callbacks
 
+   /**
+      Point the shared atlas at the font texture of this window's GL context, other editors draw with theirs.
+      The texture is created during the first frame, it is remembered once that is done.
+    */
+    void onDisplay() override
+    {
+        const std::unique_lock<std::recursive_mutex> lock(Fl3ngrFontAtlasCache::lockForDrawing());
+
+        if (fFontTexture != ImTextureID())
+            fFontAtlas->SetTexID(fFontTexture);
+
+        UI::onDisplay();
+
+        if (fFontTexture == ImTextureID())
+            fFontTexture = fFontAtlas->TexID;
+    }
+
    /**
       ImGui specific onDisplay function.
     */
     void onImGuiDisplay() override
     {
+#if FL3NGR_PROFILE
+        const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+#endif
+
         // Setup
         const float width = getWidth();
         const float height = getHeight();
@@ -147,45 +464,13 @@ protected:
         ImGui::SetNextWindowPos(ImVec2(margin, margin));
         ImGui::SetNextWindowSize(ImVec2(width - 2 * margin, height - 2 * margin));
 
-        ImGuiStyle& style = ImGui::GetStyle();
-        style.WindowTitleAlign = ImVec2(0.5f, 0.5f);
-
-        style.Colors[ImGuiCol_TitleBgActive] = (ImVec4)WstdTitleBgActive;
-        style.Colors[ImGuiCol_WindowBg] = (ImVec4)WstdWindowBg;
-
         ImGuiIO& io(ImGui::GetIO());
         ImFont* defaultFont = ImGui::GetFont();
-        ImFont* titleBarFont = io.Fonts->Fonts[2];
-        ImFont* smallFont = io.Fonts->Fonts[3];
+        ImFont* titleBarFont = io.Fonts->Fonts[kFontTitleBar];
+        ImFont* smallFont = io.Fonts->Fonts[kFontSmall];
 
         // Colors
-        auto HighColorActive     = ColorBright(Blue,   fhigh);
-        auto HighColorHovered    = ColorBright(BlueBr, fhigh);
-        auto MidColorActive      =    ColorMid(Blue,   Green,   Red,   fmid, fmid_freq);
-        auto MidColorHovered     =    ColorMid(BlueBr, GreenBr, RedBr, fmid, fmid_freq);
-        auto MidFreqColorActive  =    ColorMid(BlueBr, GreenDr, RedBr, fmid, fmid_freq);
-        auto MidFreqColorHovered =    ColorMid(Blue,   Green,   Red,   fmid, fmid_freq);
-        auto LowColorActive      = ColorBright(Red,    flow);
-        auto LowColorHovered     = ColorBright(RedBr,  flow);
-
-        auto HighRangeSw         = ColorBright(WhiteDr, fhigh, false);
-        auto HighRangeAct        = ColorBright(BlueDr, fhigh);
-        auto HighRangeActHv      = ColorBright(Blue, fhigh);
-
-        auto MidRangeSw          = ColorBright(WhiteDr, fmid, false);
-        auto MidRangeAct         = MidFreqColorActive;
-        auto MidRangeActHv       = MidFreqColorHovered;
-
-        auto LowRangeSw          = ColorBright(WhiteDr, flow, false);
-        auto LowRangeAct         = ColorBright(RedDr, flow);
-        auto LowRangeActHv       = ColorBright(Red, flow);
-
-        auto HighMixActive       = ColorMix(HighColorActive,  Yellow,   fhigh, fhigh_mix);
-        auto HighMixHovered      = ColorMix(HighColorHovered, YellowBr, fhigh, fhigh_mix);
-        auto MidMixActive        = ColorMix(MidColorActive,   Yellow,   fmid,  fmid_mix);
-        auto MidMixHovered       = ColorMix(MidColorHovered,  YellowBr, fmid,  fmid_mix);
-        auto LowMixActive        = ColorMix(LowColorActive,   Yellow,   flow,  flow_mix);
-        auto LowMixHovered       = ColorMix(LowColorHovered,  YellowBr, flow,  flow_mix);
+        updateColors();
 
         // Sizes
         auto scaleFactor         = getScaleFactor();
@@ -194,44 +479,33 @@ protected:
         const float knobWidth    = 85 * scaleFactor;
         const float toggleWidth  = 18 * scaleFactor;
         const float eqText       = 45 * scaleFactor;
+        const float choiceWidth  = 110 * scaleFactor;
+        const float voicesWidth  = 50 * scaleFactor;
 
         // Steps
-        auto high_speedstep      = 1.0f;
-        auto mid_speedstep       = 1.0f;
-        auto low_speedstep       = 1.0f;
         auto percstep            = 1.0f;
         auto dbstep              = 0.1f;
         auto hzstep              = 20.0f;
 
         if (io.KeyShift)
         {
-            high_speedstep = (fhigh_range) ? 0.01f : 0.001f;
-            mid_speedstep = (fmid_range) ? 0.01f : 0.001f;
-            low_speedstep = (flow_range) ? 0.01f : 0.001f;
-
             percstep = 0.1f;
             dbstep = 0.01f;
             hzstep = 1.0f;
         }
-        else
+
+        for (Band& band : fBands)
         {
-            high_speedstep = (fhigh_range) ? 0.1f : 0.01f;
-            mid_speedstep = (fmid_range) ? 0.1f : 0.01f;
-            low_speedstep = (flow_range) ? 0.1f : 0.01f;
+            if (band.values[kBandSpeed] > 2.0f)
+                band.range = true;
         }
 
-        if(fhigh_speed > 2.0f)
-            fhigh_range = true;
-
-        if(fmid_speed > 2.0f)
-            fmid_range = true;
-
-        if(flow_speed > 2.0f)
-            flow_range = true;
+        // the frequency knob and its label sit between the band above and the one below the crossover middle
+        const uint32_t freqRow = (kFl3ngrBandCount + 1) / 2;
 
         // Draw
         ImGui::PushFont(titleBarFont);
-        if (ImGui::Begin("WSTD FL3NGR", nullptr, ImGuiWindowFlags_NoResize + ImGuiWindowFlags_NoCollapse))
+        if (ImGui::Begin(FL3NGR_PLUGIN_NAME, nullptr, ImGuiWindowFlags_NoResize + ImGuiWindowFlags_NoCollapse))
         {
             ImGui::Dummy(ImVec2(0.0f, 8.0f) * scaleFactor);
             ImGui::PushFont(defaultFont);
@@ -262,17 +536,23 @@ protected:
             ImGui::BeginGroup();
             {
                 ImGui::PushStyleColor(ImGuiCol_Text, TextClr);
-                ImGui::Dummy(ImVec2(0.0f, 38.0f) * scaleFactor);
-                CenterTextX("High", eqText);
-                ImGui::Dummy(ImVec2(0.0f, 80.0f) * scaleFactor);
-                CenterTextX("Mid", eqText);
-                ImGui::Dummy(ImVec2(0.0f, 60.0f) * scaleFactor);
-                ImGui::PushFont(smallFont);
-                CenterTextX("Mid", eqText);
-                CenterTextX("Freq", eqText);
-                ImGui::PopFont();
-                ImGui::Dummy(ImVec2(0.0f, 60.0f) * scaleFactor);
-                CenterTextX("Low", eqText);
+                float gap = 38.0f * scaleFactor;
+
+                for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+                {
+                    if (b == freqRow)
+                    {
+                        ImGui::Dummy(ImVec2(0.0f, gap - 20.0f * scaleFactor));
+                        ImGui::PushFont(smallFont);
+                        CenterTextX(kFreqLabel, eqText);
+                        CenterTextX("Freq", eqText);
+                        ImGui::PopFont();
+                        gap = 60.0f * scaleFactor;
+                    }
+
+                    gap = drawBandLabel(kFl3ngrBands[b].name, eqText, gap);
+                    gap += 80.0f * scaleFactor;
+                }
                 ImGui::PopStyleColor();
             }
             ImGui::EndGroup();
@@ -281,440 +561,547 @@ protected:
             // EQ Section
             ImGui::BeginGroup();
             {
-                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)HighColorActive);
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)HighColorHovered);
-                if (ImGuiKnobs::Knob("High", &fhigh, -15.0f, 15.0, dbstep, "%.2fdB", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsDB, 7))
+                for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
                 {
-
-                    if (ImGui::IsItemActivated())
+                    if (b == freqRow)
                     {
-                        editParameter(0, true);
-                        if (ImGui::IsMouseDoubleClicked(0))
-                            fhigh = 0.0f;
+                        ImGui::Dummy(ImVec2(7.5f, 0.0f) * scaleFactor); ImGui::SameLine();
+                        ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)fFreqColors.freqActive);
+                        ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)fFreqColors.freqHovered);
+                        if (ImGuiKnobs::Knob(kFl3ngrParameters[paramFreq].name, &fFreq, kFl3ngrParameters[paramFreq].min, kFl3ngrParameters[paramFreq].max, hzstep, "%.1fHz", ImGuiKnobVariant_SteppedTick, seventy, ImGuiKnob_FlagsLog, 11))
+                            knobEdited(paramFreq, fFreq);
+                        ImGui::PopStyleColor(2);
                     }
-                    setParameterValue(0, fhigh);
-                }
-                ImGui::PopStyleColor(2);
 
-                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)MidColorActive);
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidColorHovered);
-                if (ImGuiKnobs::Knob("Mid", &fmid, -15.0f, 15.0, dbstep, "%.2fdB", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsDB, 7))
-                {
-                    if (ImGui::IsItemActivated())
-                    {
-                        editParameter(10, true);
-                        if (ImGui::IsMouseDoubleClicked(0))
-                            fmid = 0.0f;
-                    }
-                    setParameterValue(10, fmid);
-                }
-                ImGui::PopStyleColor(2);
-
-                ImGui::Dummy(ImVec2(7.5f, 0.0f) * scaleFactor); ImGui::SameLine();
-                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)MidFreqColorActive);
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidFreqColorHovered);
-                if (ImGuiKnobs::Knob("Mid Freq", &fmid_freq, 313.3f, 5705.6f, hzstep, "%.1fHz", ImGuiKnobVariant_SteppedTick, seventy, ImGuiKnob_FlagsLog, 11))
-                {
-                    if (ImGui::IsItemActivated())
-                    {
-                        editParameter(12, true);
-                        if (ImGui::IsMouseDoubleClicked(0))
-                            fmid_freq = 1337.0f;
-                    }
-                    setParameterValue(12, fmid_freq);
-                }
-                ImGui::PopStyleColor(2);
+                    Band& band(fBands[b]);
 
-                ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)LowColorActive);
-                ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)LowColorHovered);
-                if (ImGuiKnobs::Knob("Low", &flow, -15.0f, 15.0, dbstep, "%.2fdB", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsDB, 7))
-                {
-                    if (ImGui::IsItemActivated())
-                    {
-                        editParameter(5, true);
-                        if (ImGui::IsMouseDoubleClicked(0))
-                            flow = 0.0f;
-                    }
-                    setParameterValue(5, flow);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)band.colors.active);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)band.colors.hovered);
+                    if (ImGuiKnobs::Knob(knobName(b, kBandGain), &band.values[kBandGain], -15.0f, 15.0, dbstep, "%.2fdB", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_FlagsDB, 7))
+                        knobEdited(fl3ngrBandParameter(b, kBandGain), band.values[kBandGain]);
+                    ImGui::PopStyleColor(2);
                 }
-                ImGui::PopStyleColor(2);
             }
             ImGui::EndGroup(); ImGui::SameLine();
             ImGui::Dummy(ImVec2(20.0f, 0.0f) * scaleFactor); ImGui::SameLine();
 
-            // High Band
+            // Bands
             ImGui::BeginGroup();
             {
-                ImGui::BeginGroup();
+                for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
                 {
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)HighColorActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)HighColorHovered);
-                    if (ImGuiKnobs::Knob("High Intensity", &fhigh_intensity, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
+                    if (b == freqRow)
                     {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(2, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fhigh_intensity = 20.0f;
-                        }
-                        setParameterValue(2, fhigh_intensity);
-                    }
-                    ImGui::SameLine();
-
-                    // High Speed knob and range
-                    ImGui::BeginGroup();
-                    {
-                        auto fhigh_max = 20.0f;
-                        auto fhigh_steps = 21;
-                        if (not fhigh_range)
-                        {
-                            fhigh_max = 2.0f;
-                            fhigh_steps = 11;
-                        }
-
-                        // High Speed knob
-                        if (ImGuiKnobs::Knob("High Speed", &fhigh_speed, 0.0f, fhigh_max, high_speedstep, "%.3fHz", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, fhigh_steps))
-                        {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(4, true);
-                                if (ImGui::IsMouseDoubleClicked(0))
-                                    fhigh_speed = 2.0f;
-                            }
-                            setParameterValue(4, fhigh_speed);
-                        }
-                        ImGui::SameLine();
-
-                        // High Speed range
+                        // Effect Headers
+                        ImGui::Dummy(ImVec2(0.0f, 23.0f) * scaleFactor);
                         ImGui::BeginGroup();
                         {
-                            ImGui::Dummy(ImVec2(0.0f, 20.0f) * scaleFactor);
-
-                            // Range text
                             ImGui::PushStyleColor(ImGuiCol_Text, TextClr);
-                            ImGui::PushFont(smallFont);
-                            auto rangedef = (fhigh_range) ? "fast": "slow";
-                            CenterTextX(rangedef, toggleWidth);
-                            ImGui::PopFont();
+                            CenterTextX("Intensity", knobWidth); ImGui::SameLine();
+                            CenterTextX("Speed", knobWidth); ImGui::SameLine();
+                            CenterTextX("Range", toggleWidth); ImGui::SameLine();
+                            CenterTextX("Phase", knobWidth); ImGui::SameLine();
+                            CenterTextX("Feedback", knobWidth); ImGui::SameLine();
+                            CenterTextX("Mix", knobWidth); ImGui::SameLine();
+                            CenterTextX("Voices", voicesWidth);
                             ImGui::PopStyleColor();
-
-                            // knob
-                            ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)HighRangeSw);
-
-                            // inactive colors
-                            ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)HighRangeAct);
-                            ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)HighRangeActHv);
-
-                            // active colors
-                            ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)HighRangeAct);
-                            ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)HighRangeActHv);
-
-                            if (ImGui::Toggle("##High_Range", &fhigh_range, ImGuiToggleFlags_Animated))
-                            {
-                                if (ImGui::IsItemActivated() && !fhigh_range)
-                                {
-                                    editParameter(4, true);
-                                    fhigh_speed = std::min(fhigh_speed, 2.0f);
-                                    setParameterValue(4, fhigh_speed);
-                                }
-                            }
-                            ImGui::PopStyleColor(5);
                         }
                         ImGui::EndGroup();
+                        ImGui::Dummy(ImVec2(0.0f, 23.0f) * scaleFactor);
                     }
-                    ImGui::EndGroup();
-                    ImGui::SameLine();
-                    if (ImGuiKnobs::Knob("High Feedback", &fhigh_feedback, -100.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SpaceBipolar, hundred, ImGuiKnob_Flags))
-                    {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(1, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fhigh_feedback = 0.0f;
-                        }
-                        setParameterValue(1, fhigh_feedback);
-                    }
-                    ImGui::PopStyleColor(2);
-                    ImGui::SameLine();
 
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)HighMixActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)HighMixHovered);
-                    if (ImGuiKnobs::Knob("High Mix", &fhigh_mix, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
-                    {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(3, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fhigh_mix = 50.0f;
-                        }
-                        setParameterValue(3, fhigh_mix);
-                    }
-                    ImGui::PopStyleColor(2);
+                    drawBand(b, ImGuiKnob_Flags, percstep, io.KeyShift, smallFont);
                 }
-                ImGui::EndGroup();
+            }
+            ImGui::EndGroup();
 
-                // Mid Band
-                ImGui::BeginGroup();
-                {
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)MidColorActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidColorHovered);
-                    if (ImGuiKnobs::Knob("Mid Intensity", &fmid_intensity, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
-                    {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(13, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fmid_intensity = 20.0f;
-                        }
-                        setParameterValue(13, fmid_intensity);
-                    }
-                    ImGui::SameLine();
+            // Settings
+            ImGui::Dummy(ImVec2(0.0f, 8.0f) * scaleFactor);
+            ImGui::BeginGroup();
+            {
+                drawChoice("Crossover", paramCrossover, fCrossover, choiceWidth); ImGui::SameLine();
+                drawChoice("Sync", paramSync, fSync, choiceWidth); ImGui::SameLine();
+                drawChoice("Oversampling", paramOversampling, fOversampling, choiceWidth); ImGui::SameLine();
+                drawChoice("Interpolation", paramInterpolation, fInterpolation, choiceWidth);
+            }
+            ImGui::EndGroup();
 
-                    // Mid Speed knob and range
-                    ImGui::BeginGroup();
-                    {
-                        auto fmid_max = 20.0f;
-                        auto fmid_steps = 21;
-                        if (not fmid_range)
-                        {
-                            fmid_max = 2.0f;
-                            fmid_steps = 11;
-                        }
+            ImGui::PopFont();
+        }
+        ImGui::PopFont();
+        ImGui::End();
 
-                        // Mid Speed knob
-                        if (ImGuiKnobs::Knob("Mid Speed", &fmid_speed, 0.0f, fmid_max, mid_speedstep, "%.3fHz", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, fmid_steps))
-                        {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(15, true);
-                                if (ImGui::IsMouseDoubleClicked(0))
-                                    fmid_speed = 2.0f;
-                            }
-                            setParameterValue(15, fmid_speed);
-                        }
-                        ImGui::SameLine();
+        flushParameters();
+        flushRanges();
 
-                        // Mid Speed range
-                        ImGui::BeginGroup();
-                        {
-                            ImGui::Dummy(ImVec2(0.0f, 20.0f) * scaleFactor);
+#if FL3NGR_PROFILE
+        if (io.KeyCtrl && io.KeyShift && ImGui::IsMouseClicked(1))
+            fShowProfile = ! fShowProfile;
 
-                            // Range text
-                            ImGui::PushStyleColor(ImGuiCol_Text, TextClr);
-                            ImGui::PushFont(smallFont);
-                            auto rangedef = (fmid_range) ? "fast": "slow";
-                            CenterTextX(rangedef, toggleWidth);
-                            ImGui::PopFont();
-                            ImGui::PopStyleColor();
+        if (fShowProfile)
+        {
+            ImGui::SetNextWindowPos(ImVec2(10.0f, 40.0f) * scaleFactor);
+            ImGui::SetNextWindowBgAlpha(0.85f);
+            ImGui::PushFont(smallFont);
+            if (ImGui::Begin("Diagnostics", &fShowProfile, ImGuiWindowFlags_NoResize + ImGuiWindowFlags_AlwaysAutoResize + ImGuiWindowFlags_NoCollapse))
+            {
+                ImGui::Text("%-11s %9s %9s %9s", "ns/sample", "min", "avg", "max");
+                for (uint32_t i = 0; i < kProfileStageCount; ++i)
+                    ImGui::Text("%-11s %9.2f %9.2f %9.2f", kFl3ngrProfileStageNames[i],
+                                fProfile[i][kProfileMin], fProfile[i][kProfileAvg], fProfile[i][kProfileMax]);
+
+                ImGui::Separator();
+                ImGui::Text("%-11s %9s %9s %9s", "ui frames", "per s", "avg ms", "max ms");
+                ImGui::Text("%-11s %9u %9.3f %9.3f", "", fFrameTimes.frames,
+                            fFrameTimes.frames != 0 ? fFrameTimes.totalMs / fFrameTimes.frames : 0.0,
+                            fFrameTimes.maxMs);
+
+                ImGui::Separator();
+                ImGui::Text("%-11s %9s %9s %9s", "ui edits", "made", "sent", "gestures");
+                ImGui::Text("%-11s %9u %9u %9u", "", fEditsQueued, fEditsSent, fGesturesSent);
+
+                // the atlas keeps an alpha8 and an rgba32 copy of its pixels
+                ImGui::Separator();
+                ImGui::Text("%-11s %9s %9s %9s", "font atlas", "open ms", "KiB", "editors");
+                ImGui::Text("%-11s %9.3f %9d %9u", "", fFontSetupMs,
+                            fFontAtlas->TexWidth * fFontAtlas->TexHeight * 5 / 1024,
+                            Fl3ngrFontAtlasCache::users(fFontAtlas));
+            }
+            ImGui::End();
+            ImGui::PopFont();
+        }
 
-                            // knob
-                            ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)MidRangeSw);
-
-                            // inactive colors
-                            ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)MidRangeAct);
-                            ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)MidRangeActHv);
-
-                            // active colors
-                            ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)MidRangeAct);
-                            ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidRangeActHv);
-
-                            if (ImGui::Toggle("##Mid_Range", &fmid_range, ImGuiToggleFlags_Animated))
-                            {
-                                if (ImGui::IsItemActivated() && !fmid_range)
-                                {
-                                    editParameter(15, true);
-                                    fmid_speed = std::min(fmid_speed, 2.0f);
-                                    setParameterValue(15, fmid_speed);
-                                }
-                            }
-                            ImGui::PopStyleColor(5);
-                        }
-                        ImGui::EndGroup();
+        // build time of this frame, not counting the GL render that follows
+        const std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+        const double frameMs = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
 
-                    }
-                    ImGui::EndGroup();
-                    ImGui::SameLine();
+        ++fFrameWindow.frames;
+        fFrameWindow.totalMs += frameMs;
+        fFrameWindow.maxMs = std::max(fFrameWindow.maxMs, frameMs);
 
-                    if (ImGuiKnobs::Knob("Mid Feedback", &fmid_feedback, -100.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SpaceBipolar, hundred, ImGuiKnob_Flags))
-                    {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(11, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fmid_feedback = 0.0f;
-                        }
-                        setParameterValue(11, fmid_feedback);
-                    }
-                    ImGui::PopStyleColor(2);
-                    ImGui::SameLine();
+        if (frameEnd - fFrameWindowStart >= std::chrono::seconds(1))
+        {
+            fFrameTimes = fFrameWindow;
+            fFrameWindow = FrameTimes();
+            fFrameWindowStart = frameEnd;
+        }
+#endif
+    }
 
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)MidMixActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)MidMixHovered);
-                    if (ImGuiKnobs::Knob("Mid Mix", &fmid_mix, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
-                    {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(14, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                fmid_mix = 50.0f;
-                        }
-                        setParameterValue(14, fmid_mix);
-                    }
-                    ImGui::PopStyleColor(2);
+   /**
+      One band's row: intensity, speed with its range toggle, phase, feedback, mix, voices and the meter.
+    */
+    void drawBand(uint32_t b, int flags, float percstep, bool fine, ImFont* smallFont)
+    {
+        Band& band(fBands[b]);
+        float* const values = band.values;
+        const BandColors& colors(band.colors);
+        const float scaleFactor = getScaleFactor();
+        const float hundred = 100 * scaleFactor;
+        const float toggleWidth = 18 * scaleFactor;
+        const float voicesWidth = 50 * scaleFactor;
+        const uint32_t speed = fl3ngrBandParameter(b, kBandSpeed);
+
+        float speedstep;
+        if (fine)
+            speedstep = band.range ? 0.01f : 0.001f;
+        else
+            speedstep = band.range ? 0.1f : 0.01f;
+
+        ImGui::BeginGroup();
+        {
+            ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.active);
+            ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.hovered);
+            if (ImGuiKnobs::Knob(knobName(b, kBandIntensity), &values[kBandIntensity], 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, flags, 11))
+                knobEdited(fl3ngrBandParameter(b, kBandIntensity), values[kBandIntensity]);
+            ImGui::SameLine();
+
+            // Speed knob and range
+            ImGui::BeginGroup();
+            {
+                auto speed_max = 20.0f;
+                auto speed_steps = 21;
+                if (not band.range)
+                {
+                    speed_max = 2.0f;
+                    speed_steps = 11;
                 }
-                ImGui::EndGroup();
 
-                // Effect Headers
-                ImGui::Dummy(ImVec2(0.0f, 23.0f) * scaleFactor);
+                // Speed knob
+                if (ImGuiKnobs::Knob(knobName(b, kBandSpeed), &values[kBandSpeed], 0.0f, speed_max, speedstep, "%.3fHz", ImGuiKnobVariant_SteppedTick, hundred, flags, speed_steps))
+                    knobEdited(speed, values[kBandSpeed]);
+                ImGui::SameLine();
+
+                // Speed range
                 ImGui::BeginGroup();
                 {
+                    ImGui::Dummy(ImVec2(0.0f, 20.0f) * scaleFactor);
+
+                    // Range text
                     ImGui::PushStyleColor(ImGuiCol_Text, TextClr);
-                    CenterTextX("Intensity", knobWidth); ImGui::SameLine();
-                    CenterTextX("Speed", knobWidth); ImGui::SameLine();
-                    CenterTextX("Range", toggleWidth); ImGui::SameLine();
-                    CenterTextX("Feedback", knobWidth); ImGui::SameLine();
-                    CenterTextX("Mix", knobWidth);
+                    ImGui::PushFont(smallFont);
+                    auto rangedef = (band.range) ? "fast": "slow";
+                    CenterTextX(rangedef, toggleWidth);
+                    ImGui::PopFont();
                     ImGui::PopStyleColor();
-                }
-                ImGui::EndGroup();
-                ImGui::Dummy(ImVec2(0.0f, 23.0f) * scaleFactor);
 
-                // Low Band
-                ImGui::BeginGroup();
-                {
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)LowColorActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)LowColorHovered);
-                    if (ImGuiKnobs::Knob("Low Intensity", &flow_intensity, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
+                    // knob
+                    ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)colors.rangeSw);
+
+                    // inactive colors
+                    ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)colors.rangeAct);
+                    ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)colors.rangeActHv);
+
+                    // active colors
+                    ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)colors.rangeAct);
+                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.rangeActHv);
+
+                    if (ImGui::Toggle(band.rangeId, &band.range, ImGuiToggleFlags_Animated))
                     {
-                        if (ImGui::IsItemActivated())
+                        if (ImGui::IsItemActivated() && !band.range)
                         {
-                            editParameter(7, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                flow_intensity = 20.0f;
+                            beginEdit(speed);
+                            values[kBandSpeed] = std::min(values[kBandSpeed], 2.0f);
+                            queueParameter(speed, values[kBandSpeed]);
                         }
-                        setParameterValue(7, flow_intensity);
                     }
-                    ImGui::SameLine();
+                    ImGui::PopStyleColor(5);
+                }
+                ImGui::EndGroup();
+            }
+            ImGui::EndGroup();
+            ImGui::SameLine();
 
-                    // Low Speed knob and range
-                    ImGui::BeginGroup();
-                    {
-                        auto flow_max = 20.0f;
-                        auto flow_steps = 21;
-                        if (not flow_range)
-                        {
-                            flow_max = 2.0f;
-                            flow_steps = 11;
-                        }
+            // only moves the LFO with Sync on Host
+            if (ImGuiKnobs::Knob(knobName(b, kBandPhase), &values[kBandPhase], 0.0f, 360.0f, percstep * 3.6f, "%.0fdeg", ImGuiKnobVariant_SteppedTick, hundred, flags, 9))
+                knobEdited(fl3ngrBandParameter(b, kBandPhase), values[kBandPhase]);
+            ImGui::SameLine();
 
-                        // Low Speed knob
-                        if (ImGuiKnobs::Knob("Low Speed", &flow_speed, 0.0f, flow_max, low_speedstep, "%.3fHz", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, flow_steps))
-                        {
-                            if (ImGui::IsItemActivated())
-                            {
-                                editParameter(9, true);
-                                if (ImGui::IsMouseDoubleClicked(0))
-                                    flow_speed = 2.0f;
-                            }
-                            setParameterValue(9, flow_speed);
-                        }
-                        ImGui::SameLine();
+            if (ImGuiKnobs::Knob(knobName(b, kBandFeedback), &values[kBandFeedback], -100.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SpaceBipolar, hundred, flags))
+                knobEdited(fl3ngrBandParameter(b, kBandFeedback), values[kBandFeedback]);
+            ImGui::PopStyleColor(2);
+            ImGui::SameLine();
 
-                        // Low Speed range
-                        ImGui::BeginGroup();
-                        {
-                            ImGui::Dummy(ImVec2(0.0f, 20.0f) * scaleFactor);
+            ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)colors.mixActive);
+            ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)colors.mixHovered);
+            if (ImGuiKnobs::Knob(knobName(b, kBandMix), &values[kBandMix], 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, flags, 11))
+                knobEdited(fl3ngrBandParameter(b, kBandMix), values[kBandMix]);
+            ImGui::PopStyleColor(2);
+            ImGui::SameLine();
 
-                            // Range text
-                            ImGui::PushStyleColor(ImGuiCol_Text, TextClr);
-                            ImGui::PushFont(smallFont);
-                            auto rangedef = (flow_range) ? "fast": "slow";
-                            CenterTextX(rangedef, toggleWidth);
-                            ImGui::PopFont();
-                            ImGui::PopStyleColor();
+            // level with the middle of the knobs, the header row names it
+            ImGui::BeginGroup();
+            {
+                ImGui::Dummy(ImVec2(0.0f, 38.0f) * scaleFactor);
+                drawChoice(nullptr, fl3ngrBandParameter(b, kBandVoices), values[kBandVoices], voicesWidth);
+            }
+            ImGui::EndGroup();
+            ImGui::SameLine();
+            drawMeter(b, colors.active, hundred);
+        }
+        ImGui::EndGroup();
+    }
 
-                            // knob
-                            ImGui::PushStyleColor(ImGuiCol_Text,            (ImVec4)LowRangeSw);
-
-                            // inactive colors
-                            ImGui::PushStyleColor(ImGuiCol_FrameBg,         (ImVec4)LowRangeAct);
-                            ImGui::PushStyleColor(ImGuiCol_FrameBgHovered,  (ImVec4)LowRangeActHv);
-
-                            // active colors
-                            ImGui::PushStyleColor(ImGuiCol_Button,          (ImVec4)LowRangeAct);
-                            ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)LowRangeActHv);
-
-                            if (ImGui::Toggle("##Low_Range", &flow_range, ImGuiToggleFlags_Animated))
-                            {
-                                if (ImGui::IsItemActivated() && !flow_range)
-                                {
-                                    editParameter(9, true);
-                                    flow_speed = std::min(flow_speed, 2.0f);
-                                    setParameterValue(9, flow_speed);
-                                }
-                            }
-                            ImGui::PopStyleColor(5);
-                        }
-                        ImGui::EndGroup();
-                    }
-                    ImGui::EndGroup();
-                    ImGui::SameLine();
+   /**
+      Name of a band in the gain column, one of two words goes on two lines centred where a single one would be.
+      Returns what the second line took from the gap below it.
+    */
+    float drawBandLabel(const char* name, float width, float gap)
+    {
+        const char* const space = std::strchr(name, ' ');
+        if (space == nullptr)
+        {
+            ImGui::Dummy(ImVec2(0.0f, gap));
+            CenterTextX(name, width);
+            return 0.0f;
+        }
 
-                    if (ImGuiKnobs::Knob("Low Feedback", &flow_feedback, -100.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SpaceBipolar, hundred, ImGuiKnob_Flags))
-                    {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(6, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                flow_feedback = 0.0f;
-                        }
-                        setParameterValue(6, flow_feedback);
-                    }
-                    ImGui::PopStyleColor(2);
-                    ImGui::SameLine();
+        const float extra = 0.5f * ImGui::GetTextLineHeightWithSpacing();
+        char first[16];
+        std::snprintf(first, sizeof(first), "%.*s", static_cast<int>(space - name), name);
 
-                    ImGui::PushStyleColor(ImGuiCol_ButtonActive,    (ImVec4)LowMixActive);
-                    ImGui::PushStyleColor(ImGuiCol_ButtonHovered,   (ImVec4)LowMixHovered);
-                    if (ImGuiKnobs::Knob("Low Mix", &flow_mix, 0.0f, 100.0f, percstep, "%.1f%%", ImGuiKnobVariant_SteppedTick, hundred, ImGuiKnob_Flags, 11))
-                    {
-                        if (ImGui::IsItemActivated())
-                        {
-                            editParameter(8, true);
-                            if (ImGui::IsMouseDoubleClicked(0))
-                                flow_mix = 50.0f;
-                        }
-                        setParameterValue(8, flow_mix);
-                    }
-                    ImGui::PopStyleColor(2);
+        ImGui::Dummy(ImVec2(0.0f, gap - extra));
+        CenterTextX(first, width);
+        CenterTextX(space + 1, width);
+        return -extra;
+    }
+
+   /**
+      A choice parameter as a combo under its label, if it has one. Picking an entry sends it, opening and closing
+      the gesture.
+    */
+    void drawChoice(const char* label, uint32_t index, float& value, float width)
+    {
+        const Fl3ngrParameterInfo& info(kFl3ngrParameters[index]);
+        int item = static_cast<int>(value - info.min + 0.5f);
+        char id[40];
+        std::snprintf(id, sizeof(id), "##%s", info.receiver);
+
+        ImGui::BeginGroup();
+        {
+            if (label != nullptr)
+            {
+                ImGui::PushStyleColor(ImGuiCol_Text, TextClr);
+                CenterTextX(label, width);
+                ImGui::PopStyleColor();
+            }
+
+            ImGui::SetNextItemWidth(width);
+            if (ImGui::Combo(id, &item, fl3ngrChoiceNames(index), static_cast<int>(info.max - info.min) + 1))
+            {
+                value = info.min + item;
+                queueParameter(index, value);
+            }
+        }
+        ImGui::EndGroup();
+    }
+
+    // knobs are identified by their parameter's name
+    static const char* knobName(uint32_t band, uint32_t control)
+    {
+        return kFl3ngrParameters[fl3ngrBandParameter(band, control)].name;
+    }
+
+   /**
+      A knob moved: open the gesture when it was just grabbed, reset it on double click, queue its value.
+    */
+    void knobEdited(uint32_t index, float& value)
+    {
+        if (ImGui::IsItemActivated())
+        {
+            beginEdit(index);
+            if (ImGui::IsMouseDoubleClicked(0))
+                value = kFl3ngrParameters[index].def;
+        }
+        queueParameter(index, value);
+    }
+
+   /**
+      Meter of one band at the end of its row: RMS level with a tick at the peak, then the delay the LFO is at.
+      Hovering it shows the values.
+    */
+    void drawMeter(uint32_t band, const ImColor& color, float height)
+    {
+        const float scaleFactor = getScaleFactor();
+        const float barWidth = 5.0f * scaleFactor;
+        const float gap = 3.0f * scaleFactor;
+        const ImVec2 pos = ImGui::GetCursorScreenPos();
+        const float bottom = pos.y + height;
+
+        ImGui::Dummy(ImVec2(2.0f * barWidth + gap, height));
+
+        const float* const values = fMeters[band];
+        const float level = meterPosition(values[kTelemetryRms]);
+        const float peak = meterPosition(values[kTelemetryPeak]);
+        const float delay = delayPosition(values[kTelemetryDelay]);
+        fMeterHeight = height;
+
+        ImDrawList* const draw = ImGui::GetWindowDrawList();
+        const ImU32 background = ImGui::GetColorU32(ImGuiCol_FrameBg);
+
+        float x = pos.x;
+        draw->AddRectFilled(ImVec2(x, pos.y), ImVec2(x + barWidth, bottom), background);
+        draw->AddRectFilled(ImVec2(x, bottom - level * height), ImVec2(x + barWidth, bottom), color);
+        if (peak > 0.0f)
+            draw->AddLine(ImVec2(x, bottom - peak * height), ImVec2(x + barWidth, bottom - peak * height), Yellow, scaleFactor);
+
+        x += barWidth + gap;
+        draw->AddRectFilled(ImVec2(x, pos.y), ImVec2(x + barWidth, bottom), background);
+        draw->AddRectFilled(ImVec2(x, bottom - delay * height), ImVec2(x + barWidth, bottom), color);
+
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("peak %.1f dB\nrms %.1f dB\nlfo %.0f deg\ndelay %.2f ms",
+                              meterDb(values[kTelemetryPeak]), meterDb(values[kTelemetryRms]),
+                              values[kTelemetryPhase] * 360.0f, values[kTelemetryDelay]);
+    }
+
+    static float meterDb(float linear)
+    {
+        return fl3ngrGainToDb(std::max(linear, 1e-6f));
+    }
+
+    // -60 to +6 dB over the height of a meter
+    static float meterPosition(float linear)
+    {
+        return std::max(0.0f, std::min(1.0f, (meterDb(linear) + 60.0f) / 66.0f));
+    }
+
+    static float delayPosition(float ms)
+    {
+        return std::min(ms / static_cast<float>(Fl3ngrEngine::kMaxDelayMs), 1.0f);
+    }
+
+   /**
+      Pixel row of the meters a value is drawn at. The LFO phase is only in the tooltip, which the delay bar moves
+      with.
+    */
+    int meterPixel(uint32_t meter, float value) const
+    {
+        switch (meter)
+        {
+        case kTelemetryPeak:
+        case kTelemetryRms:   return static_cast<int>(meterPosition(value) * fMeterHeight);
+        case kTelemetryDelay: return static_cast<int>(delayPosition(value) * fMeterHeight);
+        default:              return 0;
+        }
+    }
+
+   /**
+      Open the host gesture of a parameter, once until flushParameters() sees no widget held anymore.
+    */
+    void beginEdit(uint32_t index)
+    {
+        OutboundParameter& out(fOutbound[index]);
+        if (out.gesture)
+            return;
+
+        out.gesture = true;
+        editParameter(index, true);
+#if FL3NGR_PROFILE
+        ++fGesturesSent;
+#endif
+    }
+
+   /**
+      Record a new value for a parameter, only the last one of a frame reaches the host.
+    */
+    void queueParameter(uint32_t index, float value)
+    {
+        OutboundParameter& out(fOutbound[index]);
+
+        beginEdit(index);
+        out.value = value;
+        out.pending = true;
+#if FL3NGR_PROFILE
+        ++fEditsQueued;
+#endif
+    }
+
+   /**
+      Send the edits of this frame and close the gestures of released widgets.
+      While a knob is held, moves finer than a 16-bit step of the parameter range are held back: the host's automation
+      can't tell them apart and every value sent also retargets the DSP again. The exact value is sent
+      when the gesture ends.
+    */
+    void flushParameters()
+    {
+        const bool held = ImGui::IsAnyItemActive();
+
+        for (uint32_t i = 0; i < kFl3ngrParameterCount; ++i)
+        {
+            OutboundParameter& out(fOutbound[i]);
+
+            if (out.pending)
+            {
+                const float resolution = (kFl3ngrParameters[i].max - kFl3ngrParameters[i].min) / 65536.0f;
+                const float delta = std::abs(out.value - out.sent);
+
+                if (delta > resolution || (delta != 0.0f && ! held))
+                {
+                    setParameterValue(i, out.value);
+                    out.sent = out.value;
+#if FL3NGR_PROFILE
+                    ++fEditsSent;
+#endif
                 }
-                ImGui::EndGroup();
+
+                out.pending = held && out.value != out.sent;
             }
-            ImGui::EndGroup();
 
-            if (ImGui::IsItemDeactivated())
+            if (out.gesture && ! held)
             {
-                editParameter(0, false);
-                editParameter(1, false);
-                editParameter(2, false);
-                editParameter(3, false);
-                editParameter(4, false);
-                editParameter(5, false);
-                editParameter(6, false);
-                editParameter(7, false);
-                editParameter(8, false);
-                editParameter(9, false);
-                editParameter(10, false);
-                editParameter(11, false);
-                editParameter(12, false);
-                editParameter(13, false);
-                editParameter(14, false);
-                editParameter(15, false);
+                out.gesture = false;
+                editParameter(i, false);
+#if FL3NGR_PROFILE
+                ++fGesturesSent;
+#endif
             }
+        }
+    }
 
-            ImGui::PopFont();
+   /**
+      Save the speed range toggles with the plugin state, whenever they no longer match it.
+    */
+    void flushRanges()
+    {
+#if DISTRHO_PLUGIN_WANT_STATE
+        bool ranges[kFl3ngrBandCount];
+        for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+            ranges[b] = fBands[b].range;
+
+        const std::string state = fl3ngrWriteRanges(ranges);
+        if (state == fRangesState)
+            return;
+
+        fRangesState = state;
+        setState(kFl3ngrStateRanges, state.c_str());
+#endif
+    }
+
+   /**
+      Rebuild the colors of the bands whose gain, mix or (for the bands between two others) the crossover frequency
+      moved since the last frame. The top band is blue, the bottom one red, the ones between blend by where they sit.
+    */
+    void updateColors()
+    {
+        for (uint32_t b = 0; b < kFl3ngrBandCount; ++b)
+        {
+            BandColors& c(fBands[b].colors);
+            const float gain = fBands[b].values[kBandGain];
+            const float mix = fBands[b].values[kBandMix];
+            const bool between = b != 0 && b != kFl3ngrBandCount - 1;
+
+            if (c.valid && c.gain == gain && c.mix == mix && (! between || c.freq == fFreq))
+                continue;
+
+            c.valid = true;
+            c.gain  = gain;
+            c.mix   = mix;
+            c.freq  = fFreq;
+
+            if (b == 0)
+            {
+                c.active     = ColorBright(Blue,   gain);
+                c.hovered    = ColorBright(BlueBr, gain);
+                c.rangeAct   = ColorBright(BlueDr, gain);
+                c.rangeActHv = ColorBright(Blue, gain);
+            }
+            else if (b == kFl3ngrBandCount - 1)
+            {
+                c.active     = ColorBright(Red,   gain);
+                c.hovered    = ColorBright(RedBr, gain);
+                c.rangeAct   = ColorBright(RedDr, gain);
+                c.rangeActHv = ColorBright(Red, gain);
+            }
+            else
+            {
+                const Fl3ngrParameterInfo& info(kFl3ngrParameters[paramFreq]);
+                const float center = std::max(info.min, std::min(info.max, static_cast<float>(fl3ngrBandCenter(b, fFreq))));
+
+                c.active      = ColorMid(Blue,   Green,   Red,   gain, center);
+                c.hovered     = ColorMid(BlueBr, GreenBr, RedBr, gain, center);
+                c.freqActive  = ColorMid(BlueBr, GreenDr, RedBr, gain, center);
+                c.freqHovered = ColorMid(Blue,   Green,   Red,   gain, center);
+                c.rangeAct    = c.freqActive;
+                c.rangeActHv  = c.freqHovered;
+            }
+
+            c.rangeSw    = ColorBright(WhiteDr, gain, false);
+            c.mixActive  = ColorMix(c.active,  Yellow,   gain, mix);
+            c.mixHovered = ColorMix(c.hovered, YellowBr, gain, mix);
+        }
+
+        // the frequency knob follows the gain of the band it sits under
+        BandColors& freq(fFreqColors);
+        const float gain = fBands[(kFl3ngrBandCount - 1) / 2].values[kBandGain];
+        if (! freq.valid || freq.gain != gain || freq.freq != fFreq)
+        {
+            freq.valid       = true;
+            freq.gain        = gain;
+            freq.freq        = fFreq;
+            freq.freqActive  = ColorMid(BlueBr, GreenDr, RedBr, gain, fFreq);
+            freq.freqHovered = ColorMid(Blue,   Green,   Red,   gain, fFreq);
         }
-        ImGui::PopFont();
-        ImGui::End();
     }
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImGuiPluginUI)